@@ -10,8 +10,17 @@ public:
 
 	void runGames(int playerCount, int seed);
 	void runGame(const std::vector<int>& agentAssignment, std::mt19937 rngEngine);
+
+	/// <summary>
+	/// Configures how fast RTS games are simulated.
+	/// A speedMultiplier of 0 runs the games headless, as fast as the agents allow.
+	/// </summary>
+	void setRTSSpeed(double speedMultiplier, bool lockstep);
 	
 private:
 	const SGA::GameConfig* config;
 	int gameCount;
+
+	double rtsSpeedMultiplier;
+	bool rtsLockstep;
 };
\ No newline at end of file
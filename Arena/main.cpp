@@ -14,6 +14,9 @@ int main(int argc, char** argv)
 	auto playerCount = parser.getCmdOption<int>("-playerCount", 2);
 	auto logPath = parser.getCmdOption<std::string>("-logPath", "./sgaLog.yaml");
 	auto configPath = parser.getCmdOption<std::string>("-configPath", "../../../gameConfigs/KillTheKing.yaml");
+	// RTS games run headless by default, use -rtsSpeed 1 -rtsLockstep 0 to play them in real-time
+	auto rtsSpeed = parser.getCmdOption<double>("-rtsSpeed", 0);
+	auto rtsLockstep = parser.getCmdOption<int>("-rtsLockstep", 1);
 	// Currently obsolete but configPath shouldn't have a default value. So we keep it until then
 	if(configPath.empty())
 	{
@@ -28,6 +31,7 @@ int main(int argc, char** argv)
 	// Run games
 	SGA::Log::setDefaultLogger(std::make_unique<SGA::FileLogger>(logPath));
 	GameRunner runner(gameConfig);
+	runner.setRTSSpeed(rtsSpeed, rtsLockstep != 0);
 	runner.runGames(playerCount, seed);
 	
 	return 0;
@@ -7,10 +7,16 @@
 #include <TBSLogger.h>
 
 GameRunner::GameRunner(const SGA::GameConfig& config)
-	: config(&config), gameCount(0)
+	: config(&config), gameCount(0), rtsSpeedMultiplier(0), rtsLockstep(true)
 {
 }
 
+void GameRunner::setRTSSpeed(double speedMultiplier, bool lockstep)
+{
+	rtsSpeedMultiplier = speedMultiplier;
+	rtsLockstep = lockstep;
+}
+
 void GameRunner::runGames(int playerCount, int seed)
 {
 	gameCount = 0;
@@ -23,6 +29,15 @@ void GameRunner::runGame(const std::vector<int>& agentAssignment, std::mt19937 r
 {
 	std::cout << "Initializing new game" << std::endl;
 	auto game = generateAbstractGameFromConfig(*config, rngEngine);
+	if (config->gameType == SGA::ForwardModelType::RTS)
+	{
+		auto& gameRTS = dynamic_cast<SGA::RTSGame&>(*game);
+		gameRTS.unthrottled = rtsSpeedMultiplier <= 0;
+		gameRTS.speedMultiplier = gameRTS.unthrottled ? 1 : rtsSpeedMultiplier;
+		gameRTS.lockstep = rtsLockstep;
+		gameRTS.skipIdleTicks = gameRTS.unthrottled;
+	}
+	
 	std::uniform_int_distribution<unsigned int> distribution(0, std::numeric_limits<unsigned int>::max());
 	auto agents = config->generateAgents();
 	for(size_t i = 0; i < agentAssignment.size(); i++)
@@ -58,9 +73,7 @@ void GameRunner::runGame(const std::vector<int>& agentAssignment, std::mt19937 r
 	if (config->gameType == SGA::ForwardModelType::RTS)
 	{
 		auto& gameRTS = dynamic_cast<SGA::RTSGame&>(*game);
-		const SGA::RTSForwardModel& fm = gameRTS.getForwardModel();
-		SGA::RTSGameState state = gameRTS.getStateCopy();
-		fm.buildNavMesh(state, SGA::NavigationConfig());
+		gameRTS.buildNavMesh(SGA::NavigationConfig());
 	}
 
 	// Add logger
@@ -4,6 +4,11 @@
 void RTSLogger::close()
 {
 	SGA::Log::logSingleValue("WinnerID", game->getState().winnerPlayerID);
+
+	const auto metrics = game->getMetrics();
+	SGA::Log::logSingleValue("Ticks", metrics.totalTicks);
+	SGA::Log::logSingleValue("SimulatedTime", metrics.simulatedTime);
+	SGA::Log::logSingleValue("RealTime", metrics.realTime);
 }
 
 void RTSLogger::onGameStateAdvanced()
@@ -572,6 +572,8 @@ namespace SGA
 		}
 
 		if (drawDebug) {
+			// The game thread may be rebuilding tiles of the navmesh shared with this copy
+			std::shared_lock<NavMeshLock> navMeshGuard(selectedGameStateCopy->navigation->m_navMeshLock);
 			const dtNavMesh* mesh = selectedGameStateCopy->navigation->m_navMesh;
 
 			if (mesh)
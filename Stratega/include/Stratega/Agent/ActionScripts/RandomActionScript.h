@@ -12,5 +12,8 @@ namespace SGA {
 		Action getAction(TBSGameState& gameState, std::vector<Action>& actionSpace) const override;
 		Action getActionForUnit(TBSGameState& gameState, std::vector<Action>& actionSpace, int unitID) const override;
 		[[nodiscard]] std::string toString() const override { return "RandomActionScript"; };
+
+		// Every thread draws the actions from its own generator, seeding it makes searches running in this thread reproducible
+		static void setSeed(unsigned int seed);
 	};
 }
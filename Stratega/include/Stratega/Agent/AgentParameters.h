@@ -3,15 +3,15 @@
 #include <Stratega/Agent/ActionScripts/BaseActionScript.h>
 #include <Stratega/Agent/ActionScripts/RandomActionScript.h>
 #include <Stratega/Agent/Heuristic/MinimizeDistanceHeuristic.h>
+#include <Stratega/Agent/SearchBudget.h>
 #include <Stratega/ForwardModel/PortfolioTBSForwardModel.h>
 
 
 namespace SGA {
-	struct AgentParameters {
+	// The budget of the search (MAX_FM_CALLS, MAX_TIME_MS) is inherited from SearchBudget
+	struct AgentParameters : SearchBudget {
 		
 		// agent parameters
-		int MAX_FM_CALLS = 2000;					// the maximum number of forward model calls (can be slightly exceeded in case the next generation takes more evaluations)
-		int REMAINING_FM_CALLS = MAX_FM_CALLS;	// the number of remaining forward model calls
 		int PLAYER_ID = -1;						// the agents ID in the current game
 
 		// the script the opponent is simulated with
@@ -7,6 +7,10 @@ namespace SGA
 	{
 	public:
 		double evaluateGameState(const TBSForwardModel& forwardModel, TBSGameState& gameState, const int playerID) override;
+		void evaluateBatch(const TBSForwardModel& forwardModel, std::span<TBSGameState* const> gameStates, const int playerID, std::span<double> values) override;
 		static std::string getName() { return "MinimizeDistanceHeuristic"; }
+
+	private:
+		static double evaluate(const TBSGameState& gameState, int playerID);
 	};
 }
@@ -2,6 +2,8 @@
 #include <Stratega/Representation/TBSGameState.h>
 #include <Stratega/ForwardModel/TBSForwardModel.h>
 
+#include <span>
+
 namespace SGA
 {
 	class StateHeuristic
@@ -10,6 +12,12 @@ namespace SGA
 		virtual ~StateHeuristic() = 0;
 
 		virtual double evaluateGameState(const TBSForwardModel& forwardModel, TBSGameState& gameState, const int playerID) { return 0; };
+		// Rates several states at once, values needs one element per state. Heuristics can override it to share work between the states
+		virtual void evaluateBatch(const TBSForwardModel& forwardModel, std::span<TBSGameState* const> gameStates, const int playerID, std::span<double> values)
+		{
+			for (size_t i = 0; i < gameStates.size(); i++)
+				values[i] = evaluateGameState(forwardModel, *gameStates[i], playerID);
+		}
 	};
 
 
@@ -1,14 +1,50 @@
 #pragma once
 #include <Stratega/Agent/Agent.h>
+#include <Stratega/Agent/SearchBudget.h>
+#include <Stratega/Agent/ThreadPool.h>
+#include <Stratega/Configuration/YamlHeaders.h>
 
 namespace SGA
 {
+	// OSLA rates every action once, a budget is optional and stops it before the remaining actions are rated
+	struct OSLAParameters : SearchBudget
+	{
+		OSLAParameters()
+		{
+			MAX_FM_CALLS = 0;
+			REMAINING_FM_CALLS = 0;
+		}
+
+		int THREADS = 1;	// number of threads rating the actions, the result does not depend on it
+	};
+
 	class OSLAAgent : public Agent
 	{
 	public:
+		OSLAAgent() = default;
+		explicit OSLAAgent(OSLAParameters&& params)
+			: parameters_(std::move(params))
+		{
+		}
+
 		void runTBS(TBSGameCommunicator& gameCommunicator, TBSForwardModel forwardModel) override;
 		
 	private:
+		OSLAParameters parameters_;
+		// Only created if the actions are rated by several threads
+		std::unique_ptr<ThreadPool> threadPool_;
+	};
+}
 
+namespace YAML
+{
+	template<>
+	struct convert<SGA::OSLAParameters>
+	{
+		static bool decode(const Node& node, SGA::OSLAParameters& rhs)
+		{
+			rhs.THREADS = node["Threads"].as<int>(rhs.THREADS);
+			return convert<SGA::SearchBudget>::decode(node, rhs);
+		}
 	};
-}
\ No newline at end of file
+}
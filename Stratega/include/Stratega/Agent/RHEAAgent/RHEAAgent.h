@@ -7,6 +7,11 @@
 
 #include <Stratega/Agent/RHEAAgent/RHEAGenome.h>
 #include <Stratega/Agent/RHEAAgent/RHEAParams.h>
+#include <Stratega/Agent/RHEAAgent/RHEAPrefixCache.h>
+#include <Stratega/Agent/ThreadPool.h>
+
+#include <functional>
+#include <memory>
 
 namespace SGA
 {
@@ -17,6 +22,9 @@ namespace SGA
 		std::vector<RHEAGenome> pop_;
 		std::unique_ptr<StateHeuristic>  heuristic_;
 		RHEAParams params_;
+		// Only created if the genomes are evaluated by several threads
+		std::unique_ptr<ThreadPool> threadPool_;
+		RHEAPrefixCache prefixCache_;
 
 		std::uniform_real_distribution<double> doubleDistribution_ = std::uniform_real_distribution<double>(0, 1);
 
@@ -26,17 +34,29 @@ namespace SGA
 		{
 		}
 
+		explicit RHEAAgent(RHEAParams&& params) :
+			Agent{}, params_(std::move(params))
+		{
+		}
+
 		void runTBS(TBSGameCommunicator& gameCommunicator, TBSForwardModel forwardModel) override;
 
 	private:
-		std::vector<RHEAGenome> shiftPopulation(TBSForwardModel& forwardModel, TBSGameState& gameState, std::mt19937& randomGenerator);
-		void initializePopulation(TBSForwardModel& forwardModel, TBSGameState& gameState, std::mt19937& randomGenerator);
+		std::vector<RHEAGenome> shiftPopulation(std::mt19937& randomGenerator);
+		void initializePopulation(std::mt19937& randomGenerator);
+
+		void rheaLoop(TBSGameState& gameState, std::mt19937& randomGenerator);
 
-		void rheaLoop(TBSForwardModel& forwardModel, TBSGameState& gameState, std::mt19937& randomGenerator);
+		std::vector<RHEAGenome> nextGeneration(std::mt19937& randomGenerator);
+		// Returns the two parents of a new individual, only the mutation of a population of one individual has no parents
+		std::pair<const RHEAGenome*, const RHEAGenome*> tournamentSelection(std::mt19937& randomGenerator) const;
 
-		std::vector<RHEAGenome> nextGeneration(TBSForwardModel& forwardModel, TBSGameState& gameState, std::mt19937& randomGenerator);
-		RHEAGenome getNextGenerationIndividual(TBSForwardModel& forwardModel, TBSGameState& gameState, std::mt19937& randomGenerator);
-		std::vector<RHEAGenome> tournamentSelection();
+		using GenomeGenerator = std::function<RHEAGenome(size_t index, RHEAPrefixCache::Simulation& simulation, std::mt19937& genomeRandomGenerator)>;
+		/// <summary>
+		/// Creates count genomes, in parallel if params_.THREADS is greater than 1. Every genome gets its own random generator and simulation.
+		/// Their seeds are drawn from randomGenerator and their states are cached in the order of the genomes, so the result does not depend on the number of threads.
+		/// </summary>
+		std::vector<RHEAGenome> createGenomes(size_t count, std::mt19937& randomGenerator, const GenomeGenerator& createGenome);
 	};
 	
 }
\ No newline at end of file
@@ -1,8 +1,10 @@
 #pragma once
 #include <Stratega/Agent/RHEAAgent/RHEAParams.h>
+#include <Stratega/Agent/RHEAAgent/RHEAPrefixCache.h>
 #include <Stratega/Representation/TBSGameState.h>
 #include <Stratega/ForwardModel/TBSForwardModel.h>
 
+#include <algorithm>
 #include <iostream>
 #include <random>
 #include <vector>
@@ -18,25 +20,30 @@ namespace SGA {
 
 	public:
 		// creates a random PortfolioGenome
-		RHEAGenome(TBSForwardModel& forwardModel, TBSGameState gameState, RHEAParams& params);
+		// all random decisions of a genome are drawn from the given generator, so that genomes can be created in parallel and reproducibly
+		// the actions are applied to the simulation, which starts in the root state of the turn
+		RHEAGenome(RHEAPrefixCache::Simulation& simulation, RHEAParams& params, std::mt19937& randomGenerator);
 
 		// creates a copy of an existing Portfolio Genome
 		RHEAGenome(const RHEAGenome& other) = default;
 
 		std::vector<Action>& getActions() { return actions; };
 
-		void mutate(TBSForwardModel& forwardModel, TBSGameState gameState, RHEAParams& params, std::mt19937 & randomGenerator);
+		void mutate(RHEAPrefixCache::Simulation& simulation, RHEAParams& params, std::mt19937& randomGenerator);
 
 		double getValue() const { return value; };
 		void setValue(const double value) { this->value = value; };
 
-		void shift(TBSForwardModel& forwardModel, TBSGameState gameState, RHEAParams& params);
+		void shift(RHEAPrefixCache::Simulation& simulation, std::mt19937& randomGenerator);
 		void toString() const;
-		static RHEAGenome crossover(TBSForwardModel& forwardModel, TBSGameState gameState, RHEAParams& params, std::mt19937 & randomGenerator, RHEAGenome& parent1, RHEAGenome& parent2);
+		static RHEAGenome crossover(RHEAPrefixCache::Simulation& simulation, RHEAParams& params, std::mt19937& randomGenerator, const RHEAGenome& parent1, const RHEAGenome& parent2);
 
 	private:
 		RHEAGenome(std::vector<Action>& actions, double value);
-		static void applyActionToGameState(const TBSForwardModel& forwardModel, TBSGameState& gameState, std::vector<SGA::Action>& actionSpace, const Action& action, RHEAParams& params);
+		static const Action& randomAction(const std::vector<Action>& actionSpace, std::mt19937& randomGenerator);
+		// An action planned for another state can only be executed if the forward model generates it for the current state
+		static bool isAvailable(const std::vector<Action>& actionSpace, const Action& action);
+		static bool canContinue(const RHEAPrefixCache::Simulation& simulation);
 		
 	};
 }
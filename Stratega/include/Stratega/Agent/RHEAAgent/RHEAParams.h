@@ -2,9 +2,12 @@
 #include <Stratega/Agent/ActionScripts/BaseActionScript.h>
 #include <Stratega/Agent/ActionScripts/RandomActionScript.h>
 #include <Stratega/Agent/Heuristic/MinimizeDistanceHeuristic.h>
+#include <Stratega/Agent/SearchBudget.h>
+#include <Stratega/Configuration/YamlHeaders.h>
 
 namespace SGA {
-	struct RHEAParams {
+	// The budget of the search (MAX_FM_CALLS, MAX_TIME_MS) is inherited from SearchBudget
+	struct RHEAParams : SearchBudget {
 		// basic parameters
 		size_t POP_SIZE = 10;				// population size
 		size_t INDIVIDUAL_LENGTH = 10;		// planning horizon of an individual
@@ -18,9 +21,11 @@ namespace SGA {
 		bool CONTINUE_SEARCH = true;		// initialize new population with shifted best individual of the previous iteration
 		size_t MUTATE_BEST = 9;				// include Mutate_best additional copies of the shifted best individual in the next population
 
+		// parallel evaluation
+		int THREADS = 1;					// number of threads creating and evaluating the genomes of a generation, the result does not depend on it
+		size_t PREFIX_CACHE_SIZE = 1000;	// maximum number of states reached by evaluated action prefixes kept per turn, 0 disables the cache
+
 		// agent parameters
-		int MAX_FM_CALLS = 2000;				// the maximum number of forward model calls (can be slightly exceeded in case the next generation takes more evaluations)
-		int REMAINING_FM_CALLS = MAX_FM_CALLS;	// the number of remaining forward model calls
 		int PLAYER_ID = -1;						// the agents ID in the current game
 
 		MinimizeDistanceHeuristic HEURISTIC;	// the heuristic used to evaluate a genome
@@ -30,3 +35,26 @@ namespace SGA {
 		void printDetails() const;
 	};
 }
+
+namespace YAML
+{
+	template<>
+	struct convert<SGA::RHEAParams>
+	{
+		static bool decode(const Node& node, SGA::RHEAParams& rhs)
+		{
+			rhs.POP_SIZE = node["PopulationSize"].as<size_t>(rhs.POP_SIZE);
+			rhs.INDIVIDUAL_LENGTH = node["IndividualLength"].as<size_t>(rhs.INDIVIDUAL_LENGTH);
+			rhs.MUTATION_RATE = node["MutationRate"].as<double>(rhs.MUTATION_RATE);
+			rhs.TOURNAMENT_SIZE = node["TournamentSize"].as<int>(rhs.TOURNAMENT_SIZE);
+			rhs.ELITISM = node["Elitism"].as<bool>(rhs.ELITISM);
+			rhs.CONTINUE_SEARCH = node["ContinueSearch"].as<bool>(rhs.CONTINUE_SEARCH);
+			rhs.MUTATE_BEST = node["MutateBest"].as<size_t>(rhs.MUTATE_BEST);
+			rhs.EPSILON = node["Epsilon"].as<double>(rhs.EPSILON);
+			rhs.THREADS = node["Threads"].as<int>(rhs.THREADS);
+			rhs.PREFIX_CACHE_SIZE = node["PrefixCacheSize"].as<size_t>(rhs.PREFIX_CACHE_SIZE);
+			convert<SGA::SearchBudget>::decode(node, rhs);
+			return true;
+		}
+	};
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <Stratega/Agent/RHEAAgent/RHEAParams.h>
+#include <Stratega/ForwardModel/TBSForwardModel.h>
+#include <Stratega/Representation/TBSGameState.h>
+
+#include <memory>
+#include <vector>
+
+namespace SGA {
+
+	/// <summary>
+	/// A trie of the action sequences evaluated in the current turn, every node stores the state reached by its prefix.
+	/// Genomes share long prefixes with their parents, so an evaluation follows the cached prefix and only simulates the remaining actions.
+	/// The opponent's answer to the n-th action is drawn with a seed that only depends on n, so a cached state is the state the genome would reach by itself.
+	/// </summary>
+	class RHEAPrefixCache
+	{
+	public:
+		struct Node
+		{
+			Action action;						// the action leading to this node, unused in the root
+			TBSGameState gameState;				// the state after the action and the opponent's answer
+			std::vector<Action> actionSpace;
+			std::vector<std::unique_ptr<Node>> children;
+		};
+
+		/// <summary>
+		/// Applies the actions of one genome, starting at the root of the cache.
+		/// The cache is only read, the states simulated on the way are kept until they are added with RHEAPrefixCache::insert.
+		/// Thus the genomes of a generation can be simulated in parallel and the cache does not depend on the order they finished in.
+		/// </summary>
+		class Simulation
+		{
+		public:
+			Simulation(const RHEAPrefixCache& cache, RHEAParams& params);
+
+			const TBSGameState& getGameState() const { return node != nullptr ? node->gameState : gameState; }
+			const std::vector<Action>& getActionSpace() const { return node != nullptr ? node->actionSpace : actionSpace; }
+
+			// Applies the action and lets the opponent play until it is our turn again
+			void applyAction(const Action& action);
+			// Rates the current state from the perspective of the player to move in the root
+			double evaluate();
+
+		private:
+			friend class RHEAPrefixCache;
+
+			const RHEAPrefixCache& cache;
+			RHEAParams& params;
+			size_t depth = 0;
+
+			// The cached node of the current prefix, nullptr once the simulation left the cache
+			Node* node;
+			// The state and actions of the simulation after leaving the cache
+			TBSGameState gameState;
+			std::vector<Action> actionSpace;
+
+			// The deepest cached node and the states simulated after it
+			Node* branch = nullptr;
+			std::vector<Node> newNodes;
+		};
+
+		// Starts caching the prefixes of a new turn, a cache of maxStates 0 only stores the root
+		void reset(const TBSForwardModel& forwardModel, const TBSGameState& rootState, unsigned int opponentSeed, size_t maxStates);
+		// Adds the states simulated by the given simulation as long as the cache is not full
+		void insert(Simulation& simulation);
+
+		[[nodiscard]] size_t getStateCount() const { return stateCount; }
+
+	private:
+		static Node* findChild(const Node& node, const Action& action);
+
+		const TBSForwardModel* forwardModel = nullptr;
+		std::unique_ptr<Node> root;
+		unsigned int opponentSeed = 0;
+		size_t maxStates = 0;
+		size_t stateCount = 0;
+	};
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <Stratega/Configuration/YamlHeaders.h>
+
+#include <atomic>
+#include <chrono>
+
+namespace SGA
+{
+	/// <summary>
+	/// Limits a search by forward model calls, by wall-clock time or by both, a limit of 0 is disabled.
+	/// The search counts its forward model calls in REMAINING_FM_CALLS and asks isBudgetExhausted whether to continue.
+	/// Searches that do not end by themselves need at least one of the limits.
+	/// The clock is only read every TIME_CHECK_INTERVAL checks, so a search can exceed MAX_TIME_MS by the time of a few iterations.
+	/// </summary>
+	struct SearchBudget
+	{
+		using Clock = std::chrono::steady_clock;
+
+		int MAX_FM_CALLS = 2000;				// the maximum number of forward model calls (can be slightly exceeded in case the next generation takes more evaluations)
+		int REMAINING_FM_CALLS = MAX_FM_CALLS;	// the number of remaining forward model calls
+		int MAX_TIME_MS = 0;					// the maximum duration of a search in milliseconds
+		int TIME_CHECK_INTERVAL = 8;			// the number of isBudgetExhausted calls between two reads of the clock
+
+		// Resets the forward model calls and starts the clock of a new search
+		void startBudget() { startBudget(Clock::now()); }
+		// Resets the forward model calls, the time is measured from the given start, e.g. the start of the search a thread belongs to
+		void startBudget(Clock::time_point start);
+		bool isBudgetExhausted();
+
+		// Searches whose threads share one budget count their calls with consumeFMCalls and check the budget with isSharedBudgetExhausted
+		// Both are thread-safe, isSharedBudgetExhausted reads the clock on every check
+		void consumeFMCalls(int calls) { std::atomic_ref<int>(REMAINING_FM_CALLS).fetch_sub(calls, std::memory_order_relaxed); }
+		bool isSharedBudgetExhausted();
+		[[nodiscard]] bool isTimeExhausted() const { return MAX_TIME_MS > 0 && getElapsedMilliseconds() >= MAX_TIME_MS; }
+
+		[[nodiscard]] Clock::time_point getStartTime() const { return startTime; }
+		[[nodiscard]] double getElapsedMilliseconds() const;
+
+	private:
+		Clock::time_point startTime = Clock::now();
+		int checksUntilClock = 0;
+		bool isTimeOver = false;
+	};
+}
+
+namespace YAML
+{
+	// Agents decode their budget with this, so that all of them use the same keys
+	template<>
+	struct convert<SGA::SearchBudget>
+	{
+		static bool decode(const Node& node, SGA::SearchBudget& rhs)
+		{
+			rhs.MAX_FM_CALLS = node["FmCalls"].as<int>(rhs.MAX_FM_CALLS);
+			rhs.MAX_TIME_MS = node["TimeBudgetMs"].as<int>(rhs.MAX_TIME_MS);
+			rhs.TIME_CHECK_INTERVAL = node["TimeCheckInterval"].as<int>(rhs.TIME_CHECK_INTERVAL);
+			rhs.REMAINING_FM_CALLS = rhs.MAX_FM_CALLS;
+			return true;
+		}
+	};
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SGA
+{
+	/// <summary>
+	/// Keeps a fixed number of worker threads alive, so that agents can run many small parallel loops per turn without starting threads every time.
+	/// The thread calling parallelFor works on the loop as well, so a pool of n threads starts n - 1 workers.
+	/// </summary>
+	class ThreadPool
+	{
+	public:
+		explicit ThreadPool(int threadCount);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/// <summary>
+		/// Calls task(i) for every i from 0 to count - 1 and returns once all calls are finished.
+		/// The calls run in any order and on any thread of the pool, tasks that need to be reproducible have to depend on i only.
+		/// </summary>
+		void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+		[[nodiscard]] int getThreadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+	private:
+		void work();
+		void runTasks();
+
+		std::vector<std::thread> workers;
+		std::mutex mutex;
+		std::condition_variable workAvailable;
+		std::condition_variable workFinished;
+
+		// The current loop, set while holding the mutex before the workers are woken up
+		const std::function<void(size_t)>* task = nullptr;
+		size_t taskCount = 0;
+		std::atomic<size_t> nextTask = 0;
+		// Incremented for every loop, so that each worker joins every loop once
+		unsigned int loop = 0;
+		size_t busyWorkers = 0;
+		bool isStopping = false;
+	};
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <Stratega/Agent/Agent.h>
+#include <Stratega/Agent/Heuristic/MinimizeDistanceHeuristic.h>
+#include <Stratega/Agent/TreeSearchAgents/TranspositionTable.h>
+#include <Stratega/Agent/SearchBudget.h>
+#include <Stratega/Configuration/YamlHeaders.h>
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace SGA
+{
+	// Result of searching a state this many actions deep, the value lies within the bound
+	struct AlphaBetaTransposition
+	{
+		enum class Bound { Exact, Lower, Upper };
+
+		int remainingDepth = 0;
+		double value = 0;
+		Bound bound = Bound::Exact;
+		// index of the best action in the action space of the state, it is tried first when the state is searched again
+		int bestActionIndex = -1;
+
+		int getPriority() const { return remainingDepth; }
+	};
+
+	// The budget of the search (MAX_FM_CALLS, MAX_TIME_MS) is inherited from SearchBudget, by default each action is searched for 100 milliseconds
+	struct AlphaBetaParameters : SearchBudget
+	{
+		AlphaBetaParameters()
+		{
+			MAX_FM_CALLS = 0;
+			REMAINING_FM_CALLS = 0;
+			MAX_TIME_MS = 100;
+		}
+
+		// maximum depth in actions the iterative deepening stops at, 0 deepens until the budget is used up
+		int MAX_DEPTH = 0;
+		// maximum number of states in the transposition table, it is kept between iterations and turns, 0 disables it
+		int TRANSPOSITION_TABLE_SIZE = 100000;
+		// number of actions per depth that caused a cutoff and are tried early in the siblings of their state, 0 disables killer moves
+		int KILLER_MOVES = 2;
+		// if true, the remaining actions are ordered by how much they caused cutoffs during the search of the current action
+		bool HISTORY_HEURISTIC = true;
+	};
+
+	/// <summary>
+	/// Iterative-deepening alpha-beta search over single actions. The agent maximizes the heuristic, all other players minimize it (paranoid search),
+	/// so with two players it is a regular alpha-beta search. Each iteration tries the best action of the previous one first,
+	/// followed by the killer moves of the depth and the actions with the highest history score.
+	/// The search needs a budget or a maximum depth, the best action of the deepest iteration that searched at least one root action completely is executed.
+	/// </summary>
+	class AlphaBetaAgent : public Agent
+	{
+	public:
+		AlphaBetaAgent() = default;
+		explicit AlphaBetaAgent(AlphaBetaParameters&& params)
+			: parameters_(std::move(params))
+		{
+		}
+
+		void runTBS(TBSGameCommunicator& gameCommunicator, TBSForwardModel forwardModel) override;
+
+	private:
+		// Returns the index of the action to execute
+		size_t search(TBSForwardModel& forwardModel, TBSGameState& gameState);
+		// Returns the value of the state, bestActionIndex is the best action among the completely searched ones or -1
+		double alphaBeta(TBSForwardModel& forwardModel, TBSGameState& gameState, int depth, double alpha, double beta, size_t ply, int& bestActionIndex);
+		std::vector<size_t> orderActions(const std::vector<Action>& actionSpace, int transpositionActionIndex, size_t ply) const;
+		void addCutoff(const Action& action, int depth, size_t ply);
+
+		AlphaBetaParameters parameters_;
+		MinimizeDistanceHeuristic heuristic_;
+		std::unique_ptr<TranspositionTable<AlphaBetaTransposition>> transpositionTable_;
+
+		// The newest killer move of a depth comes first
+		std::vector<std::vector<Action>> killerMoves_;
+		std::unordered_map<std::uint64_t, std::int64_t> history_;
+
+		int playerID_ = -1;
+		// Best root action of the previous iteration, it is searched first, so that an aborted iteration only replaces it by a better action
+		int rootActionIndex_ = -1;
+		bool isAborted_ = false;
+		// Whether the current subtree was cut off by the depth limit, otherwise its value is exact for any depth
+		bool isDepthLimited_ = false;
+	};
+}
+
+namespace YAML
+{
+	template<>
+	struct convert<SGA::AlphaBetaParameters>
+	{
+		static bool decode(const Node& node, SGA::AlphaBetaParameters& rhs)
+		{
+			rhs.MAX_DEPTH = node["MaxDepth"].as<int>(rhs.MAX_DEPTH);
+			rhs.TRANSPOSITION_TABLE_SIZE = node["TranspositionTableSize"].as<int>(rhs.TRANSPOSITION_TABLE_SIZE);
+			rhs.KILLER_MOVES = node["KillerMoves"].as<int>(rhs.KILLER_MOVES);
+			rhs.HISTORY_HEURISTIC = node["HistoryHeuristic"].as<bool>(rhs.HISTORY_HEURISTIC);
+			convert<SGA::SearchBudget>::decode(node, rhs);
+			return true;
+		}
+	};
+}
@@ -1,34 +1,85 @@
 #pragma once
 #include <Stratega/Agent/Agent.h>
 #include <Stratega/Agent/TreeSearchAgents/TreeNode.h>
+#include <Stratega/Agent/TreeSearchAgents/TranspositionTable.h>
 #include <Stratega/Agent/AgentParameters.h>
+#include <Stratega/Configuration/YamlHeaders.h>
 
 #include <list>
 #include <memory>
+#include <random>
 
 namespace SGA
 {
 	struct BFSParameters : public AgentParameters
 	{
 		bool CONTINUE_PREVIOUS_SEARCH = true;
+		// Maximum number of states in the transposition table, nodes with a state that was already found are not expanded, 0 disables it
+		int TRANSPOSITION_TABLE_SIZE = 0;
+		// If true, a node only keeps its state while it is expanded and replays it from its ancestors otherwise.
+		// Replaying costs forward model calls, but the memory of the tree no longer grows with the size of the states
+		bool REPLAY_STATES = false;
+		// Maximum number of open nodes, once it is exceeded only the best ones are kept and the search continues as a beam search, 0 disables it.
+		// Only the open nodes keep their states then, the states of all other nodes are released and replayed when needed
+		size_t MAX_OPEN_NODES = 0;
+	};
+
+	// Depth of the shallowest node with the state
+	struct BFSTransposition
+	{
+		int depth = 0;
+
+		int getPriority() const { return -depth; }
 	};
 
 	class BFSAgent : public Agent
 	{
-		std::unique_ptr<TreeNode> rootNode = nullptr;
+		// The arena owns the tree, rootNode can be a subtree of it when the previous search is continued
+		NodeArena<TreeNode> nodeArena;
+		TreeNode* rootNode = nullptr;
 		std::list<TreeNode*> openNodes = std::list<TreeNode*>();
 		std::list<TreeNode*> knownLeaves = std::list<TreeNode*>();
 		int previousActionIndex = -1;
+		std::unique_ptr<TranspositionTable<BFSTransposition>> transpositionTable;
+		// Draws the seeds of the transitions, so that nodes without a state can replay it
+		std::mt19937 transitionSeeds;
 		
 		BFSParameters parameters_;
 		
 	public:
+		BFSAgent() = default;
+		explicit BFSAgent(BFSParameters&& params)
+			: parameters_(std::move(params))
+		{
+		}
+
 		void runTBS(TBSGameCommunicator& gameCommunicator, TBSForwardModel forwardModel) override;
 
 	private:
 		void search(TBSForwardModel& forwardModel, std::list<TreeNode*>& openNodes);
-		int getBestActionIdx(TBSForwardModel& forwardModel);
+		int getBestActionIdx() const;
 		void fillOpenNodeListWithLeaves();
 		void init(TBSForwardModel& forwardModel, TBSGameState& gameState);
+		// Adds the state of the node to the transposition table, returns true if a node with the same state is not deeper in the tree
+		bool isTransposition(TreeNode* node);
+		// Keeps the best open nodes once there are more than MAX_OPEN_NODES, ties are broken by the order of the list
+		void pruneOpenNodes();
+	};
+}
+
+namespace YAML
+{
+	template<>
+	struct convert<SGA::BFSParameters>
+	{
+		static bool decode(const Node& node, SGA::BFSParameters& rhs)
+		{
+			convert<SGA::SearchBudget>::decode(node, rhs);
+			rhs.CONTINUE_PREVIOUS_SEARCH = node["ContinuePreviousSearch"].as<bool>(rhs.CONTINUE_PREVIOUS_SEARCH);
+			rhs.TRANSPOSITION_TABLE_SIZE = node["TranspositionTableSize"].as<int>(rhs.TRANSPOSITION_TABLE_SIZE);
+			rhs.REPLAY_STATES = node["ReplayStates"].as<bool>(rhs.REPLAY_STATES);
+			rhs.MAX_OPEN_NODES = node["MaxOpenNodes"].as<size_t>(rhs.MAX_OPEN_NODES);
+			return true;
+		}
 	};
 }
@@ -1,7 +1,8 @@
 #pragma once
 #include <Stratega/Agent/Agent.h>
-#include <Stratega/Agent/TreeSearchAgents/TreeNode.h>
 #include <Stratega/Agent/AgentParameters.h>
+#include <Stratega/Agent/ThreadPool.h>
+#include <Stratega/Configuration/YamlHeaders.h>
 
 namespace SGA
 {
@@ -9,19 +10,70 @@ namespace SGA
 	{
 		size_t PLAYER_BEAM_WIDTH = 20;
 		size_t PLAYER_BEAM_DEPTH = 5;
+		// maximum number of states the beam and the children of a layer keep at once, besides the chunk of children each thread simulates before rating them, 0 disables the cap
+		// a chunk holds at most as many children as a beam node keeps
+		// a cap below twice the width narrows the beam and keeps fewer children per beam node
+		size_t PLAYER_BEAM_MAX_STATES = 0;
+		// number of threads expanding the nodes of the beam, without a budget the result does not depend on it
+		int THREADS = 1;
+
+		// The beam is limited by its width and depth, a budget is optional and stops the search before the next node is expanded
+		BeamSearchParameters()
+		{
+			MAX_FM_CALLS = 0;
+			REMAINING_FM_CALLS = 0;
+		}
 	};
 	
 	class BeamSearchAgent : public Agent
 	{
 	private:
+		// A node of the beam only keeps its state and the root action it descends from, which is all that is needed to act on the result
+		struct BeamNode
+		{
+			TBSGameState gameState;
+			double value = 0;
+			size_t rootActionIndex = 0;
+		};
+
 		BeamSearchParameters parameters_ = BeamSearchParameters();
+		// Only created if the beam is expanded by several threads
+		std::unique_ptr<ThreadPool> threadPool_;
 
 	public:
+		BeamSearchAgent() = default;
+		explicit BeamSearchAgent(BeamSearchParameters&& params)
+			: parameters_(std::move(params))
+		{
+		}
+
 		void runTBS(TBSGameCommunicator& gameCommunicator, TBSForwardModel forwardModel) override;
 
 	private:	
-		Action beamSearch(TBSForwardModel& forwardModel, TreeNode& root);
-		std::vector<TreeNode*> simulate(TBSForwardModel& forwardModel, TreeNode& node);
-		static bool sortByValue(const TreeNode* i, const TreeNode* j);
+		Action beamSearch(TBSForwardModel& forwardModel, TBSGameState& gameState, const std::vector<Action>& rootActions, std::mt19937& randomGenerator);
+		// Expands every node of the beam and returns the best children of the layer, nodes that fall out of the beam are destroyed right away
+		// The random actions of the i-th node are drawn with layerSeed + i, so that they do not depend on the thread expanding it
+		std::vector<BeamNode> expandLayer(TBSForwardModel& forwardModel, std::vector<BeamNode>& beam, bool isRootLayer, unsigned int layerSeed);
+		// Returns the best children of the node sorted by their value
+		// The children are simulated and rated in chunks of keepCount, so that at most twice as many of them are alive at any time
+		std::vector<BeamNode> simulate(TBSForwardModel& forwardModel, BeamNode& node, bool isRoot, size_t keepCount);
+		static bool sortByValue(const BeamNode& i, const BeamNode& j);
+	};
+}
+
+namespace YAML
+{
+	template<>
+	struct convert<SGA::BeamSearchParameters>
+	{
+		static bool decode(const Node& node, SGA::BeamSearchParameters& rhs)
+		{
+			rhs.PLAYER_BEAM_WIDTH = node["BeamWidth"].as<size_t>(rhs.PLAYER_BEAM_WIDTH);
+			rhs.PLAYER_BEAM_DEPTH = node["BeamDepth"].as<size_t>(rhs.PLAYER_BEAM_DEPTH);
+			rhs.PLAYER_BEAM_MAX_STATES = node["BeamMaxStates"].as<size_t>(rhs.PLAYER_BEAM_MAX_STATES);
+			rhs.THREADS = node["Threads"].as<int>(rhs.THREADS);
+			convert<SGA::SearchBudget>::decode(node, rhs);
+			return true;
+		}
 	};
 }
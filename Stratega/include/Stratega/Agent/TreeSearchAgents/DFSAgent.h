@@ -3,29 +3,83 @@
 #include <Stratega/Agent/Heuristic/MinimizeDistanceHeuristic.h>
 #include <Stratega/Agent/ActionScripts/BaseActionScript.h>
 #include <Stratega/Agent/ActionScripts/RandomActionScript.h>
+#include <Stratega/Agent/TreeSearchAgents/TranspositionTable.h>
+#include <Stratega/Agent/SearchBudget.h>
+#include <Stratega/Agent/ThreadPool.h>
+#include <Stratega/Configuration/YamlHeaders.h>
+
+#include <mutex>
 
 namespace SGA
 {
+	// Value of a state that was searched this many actions deep
+	struct DFSTransposition
+	{
+		int remainingDepth = 0;
+		double value = 0;
+
+		int getPriority() const { return remainingDepth; }
+	};
+
+	// The budget of the search (MAX_FM_CALLS, MAX_TIME_MS) is inherited from SearchBudget
+	struct DFSParameters : SearchBudget
+	{
+		int MAX_DEPTH = 3;
+		// maximum number of states in the transposition table, states that were already searched deep enough are not searched again, 0 disables it
+		// the table is shared by all root actions, which simulate the opponent with different seeds, so a stored value depends on the root action that searched the state first
+		// with several threads this order changes from run to run, thus a search with a transposition table is only reproducible with a single thread
+		int TRANSPOSITION_TABLE_SIZE = 0;
+		// number of threads searching the subtrees of the root actions, they share the budget
+		// without a transposition table and with an unlimited budget the result does not depend on the number of threads
+		int THREADS = 1;
+	};
+
 	class DFSAgent : public Agent
 	{
 
 	public:
 		MinimizeDistanceHeuristic _stateHeuristic;
-		int maxDepth = 3;
-		int forwardModelCalls = 2000;
-		int remainingForwardModelCalls = forwardModelCalls;
 		std::unique_ptr<BaseActionScript> opponentModel = std::make_unique<RandomActionScript>();	// the portfolio the opponent is simulated with, if set to nullptr the opponent's turn will be skipped
+		std::unique_ptr<TranspositionTable<DFSTransposition>> transpositionTable;
 
 		DFSAgent() :
 			Agent{},
 			_stateHeuristic()
 		{
 		}
+
+		explicit DFSAgent(DFSParameters&& params) :
+			Agent{},
+			_stateHeuristic(),
+			parameters_(std::move(params))
+		{
+		}
 		
 		void runTBS(TBSGameCommunicator& gameCommunicator, TBSForwardModel forwardModel) override;
 
 		double evaluateRollout(TBSForwardModel& forwardModel, TBSGameState& gameState, int depth, int playerID);
 		void applyActionToGameState(const TBSForwardModel& forwardModel, TBSGameState& gameState, const Action& action);
 
+	private:
+		DFSParameters parameters_;
+		// Only created if the root actions are searched by several threads
+		std::unique_ptr<ThreadPool> threadPool_;
+		std::mutex transpositionMutex_;
+	};
+}
+
+namespace YAML
+{
+	template<>
+	struct convert<SGA::DFSParameters>
+	{
+		static bool decode(const Node& node, SGA::DFSParameters& rhs)
+		{
+			rhs.MAX_DEPTH = node["MaxDepth"].as<int>(rhs.MAX_DEPTH);
+			rhs.TRANSPOSITION_TABLE_SIZE = node["TranspositionTableSize"].as<int>(rhs.TRANSPOSITION_TABLE_SIZE);
+			rhs.THREADS = node["Threads"].as<int>(rhs.THREADS);
+			convert<SGA::SearchBudget>::decode(node, rhs);
+			return true;
+		}
 	};
 }
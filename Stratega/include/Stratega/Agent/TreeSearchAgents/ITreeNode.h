@@ -1,36 +1,55 @@
 #pragma once
+#include <Stratega/Agent/TreeSearchAgents/NodeArena.h>
 #include <Stratega/Representation/TBSGameState.h>
 #include <Stratega/ForwardModel/TBSForwardModel.h>
 
+#include <span>
+
 namespace SGA
 {
 	template<typename NodeType>
 	class ITreeNode
 	{
+	protected:
+		NodeArena<NodeType>* arena;
+
 	public:
 		TBSGameState gameState;
 		NodeType* parentNode = nullptr;
-		std::vector<std::unique_ptr<NodeType>> children;
+		// The children are stored in one block of the arena with room for the whole action space, in the order of the action space
+		std::span<NodeType> children;
+		// Start of the block of children, it is set by the first addChild and does not change afterwards
+		NodeType* childBlock = nullptr;
 		std::vector<Action> actionSpace;
 		int childIndex = 0;
-		double value = 0;
+		// value is the last member, so that the statistics of a derived node that uct reads lie next to it
+		alignas(32) double value = 0;
 		
 	public:
-		ITreeNode(TBSForwardModel& forwardModel, TBSGameState gameState) :
-			ITreeNode(forwardModel, std::move(gameState), nullptr, 0)
+		ITreeNode(NodeArena<NodeType>& arena, TBSForwardModel& forwardModel, TBSGameState gameState) :
+			ITreeNode(arena, forwardModel, std::move(gameState), nullptr, 0)
 		{
 		}
 
+		// Root node that searches the given actions instead of generating them
+		ITreeNode(NodeArena<NodeType>& arena, TBSGameState gameState, std::vector<Action> actionSpace) :
+			arena(&arena), gameState(std::move(gameState)), actionSpace(std::move(actionSpace))
+		{
+		}
 	
-		ITreeNode(TBSForwardModel& forwardModel, TBSGameState gameState, NodeType* parent, const int childIndex) :
-			gameState(std::move(gameState)), parentNode(parent), childIndex(childIndex)
+		ITreeNode(NodeArena<NodeType>& arena, TBSForwardModel& forwardModel, TBSGameState gameState, NodeType* parent, const int childIndex) :
+			arena(&arena), gameState(std::move(gameState)), parentNode(parent), childIndex(childIndex)
 		{
-			children = std::vector<std::unique_ptr<NodeType>>();
-			
 			actionSpace = forwardModel.generateActions(this->gameState);
 		}
 		
-		virtual ~ITreeNode() = default;
+		// The memory of the nodes belongs to the arena, only the children have to be destroyed
+		virtual ~ITreeNode()
+		{
+			for (auto& child : children)
+				child.~NodeType();
+		}
+
 		//virtual std::string toString() const = 0;
 		virtual void print() const = 0;
 
@@ -38,6 +57,17 @@ namespace SGA
 		[[nodiscard]] bool isFullyExpanded() const {
 			return children.size() >= actionSpace.size();
 		}
+
+		// Constructs the next child, the arguments are passed after the arena
+		template<typename... Args>
+		NodeType* addChild(Args&&... args)
+		{
+			if (childBlock == nullptr)
+				childBlock = arena->allocate(actionSpace.size());
+			auto* child = new (childBlock + children.size()) NodeType(*arena, std::forward<Args>(args)...);
+			children = std::span<NodeType>(childBlock, children.size() + 1);
+			return child;
+		}
 		
 		void printTree(const std::string& prefix, const ITreeNode<NodeType>* node, bool isLast, const std::string& actionName) const
 		{
@@ -59,7 +89,7 @@ namespace SGA
 					// enter the next tree level - left and right branch
 					for (size_t i = 0; i < node->children.size(); ++i)
 					{
-						printTree(prefix + (isLast ? "   " : "|  "), node->children[i].get(), i == (node->children.size() - 1),
+						printTree(prefix + (isLast ? "   " : "|  "), &node->children[i], i == (node->children.size() - 1),
 							"");
 					}
 				}
@@ -83,6 +113,7 @@ namespace SGA
 			printTree("", this, true, "root");
 		};
 
+		ITreeNode(const ITreeNode&) = delete;
 		ITreeNode& operator=(const ITreeNode&) = delete;
 	};
 }
@@ -17,8 +17,30 @@ namespace SGA
 		
 		void runTBS(TBSGameCommunicator& gameCommunicator, TBSForwardModel forwardModel) override;
 
+		/// <summary>
+		/// Searches a new tree for the given state and returns the selected action, used to compare the search modes outside of a game.
+		/// </summary>
+		Action searchAction(TBSForwardModel& forwardModel, const TBSGameState& gameState, std::mt19937& randomGenerator);
+
 	private:
-		std::unique_ptr<MCTSNode> rootNode = nullptr;
+		/// <summary>
+		/// Searches one tree per thread, each with its own share of the forward model calls and its own random generator.
+		/// The statistics of the root children of all trees are summed up to select the action.
+		/// </summary>
+		Action searchRootParallel(TBSForwardModel& forwardModel, const TBSGameState& gameState, std::mt19937& randomGenerator);
+		// Searches the tree with one thread, or with all threads if SHARED_TREE is set
+		void searchTree(TBSForwardModel& forwardModel, MCTSNode& root, std::mt19937& randomGenerator);
+		// Creates or resets the transposition tables of the given number of trees, if they are enabled
+		void prepareTranspositionTables(int count, bool newTree);
+		TranspositionTable<MCTSStatistics>* getTranspositionTable(int index) const;
+
+		// The arena owns the tree, rootNode can be a subtree of it when the previous search is continued
+		NodeArena<MCTSNode> nodeArena;
+		MCTSNode* rootNode = nullptr;
+		// One arena for the tree of every thread of a root parallel search, kept to reuse their memory
+		std::vector<std::unique_ptr<NodeArena<MCTSNode>>> threadArenas;
+		// One table per tree, kept between searches
+		std::vector<std::unique_ptr<TranspositionTable<MCTSStatistics>>> transpositionTables;
 		int previousActionIndex = -1;
 		MCTSParameters parameters_;
 		bool continuePreviousSearch = true;
@@ -2,17 +2,39 @@
 #include <Stratega/Agent/TreeSearchAgents/MCTSParameters.h>
 #include <Stratega/Agent/TreeSearchAgents/TreeNode.h>
 
+#include <atomic>
+#include <mutex>
+
 namespace SGA {
 
 	class MCTSNode : public ITreeNode<MCTSNode>
 	{
+	protected:
+		// The statistics read by uct come first, so they share a cache line with value
+		// In a shared tree the statistics are read and written atomically, see SHARED_TREE in MCTSParameters
+		int nVisits = 0;
+		double bounds[2] = {0, 1};// {numeric_limits<double>::min(), numeric_limits<double>::max()};
+
 	public:
 		int nodeDepth = 0;
 		int treesize = 1;
 
 	protected:
-		int nVisits = 0;
-		double bounds[2] = {0, 1};// {numeric_limits<double>::min(), numeric_limits<double>::max()};
+		// Number of children that can be read without holding the expansionMutex
+		// The block of children is allocated once for the whole action space, so published children never move
+		// Readers iterate childBlock up to this count, the children span is only consistent under the expansionMutex
+		std::atomic<size_t> expandedChildren = 0;
+		std::mutex expansionMutex;
+
+		// With REPLAY_STATES most nodes do not keep their gameState, only its isGameOver and currentPlayer stay valid
+		// All three are set before the node is published and do not change afterwards
+		bool hasState = true;
+		// Actions since the closest ancestor that kept its state
+		int replayDistance = 0;
+		// Seed of the random action scripts while the action of the node is applied, so that replaying it gives the same state
+		unsigned int transitionSeed = 0;
+		// Only computed if the search uses a transposition table
+		std::uint64_t stateHash = 0;
 
 	public:
 		
@@ -20,16 +42,24 @@ namespace SGA {
 		void increaseTreeSize();
 
 		// tree policy phase
-		MCTSNode* treePolicy(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator);
-		MCTSNode* expand(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator);
+		// leafState receives the state of the selected node if the node did not keep it
+		MCTSNode* treePolicy(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator, TBSGameState& leafState);
+		MCTSNode* expand(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator, TBSGameState& childState);
 		MCTSNode* uct(MCTSParameters& params, std::mt19937& randomGenerator);
 
 		// rollout phase
-		double rollOut(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator);
+		double rollOut(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator, TBSGameState& state);
+		// Plays the random actions of a rollout from this node on the given state
+		void playRollout(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator, TBSGameState& state) const;
 		static bool rolloutFinished(TBSGameState& rollerState, int depth, MCTSParameters& params);
 
 		// backpropagation phase
 		static void backUp(MCTSNode* node, double result);
+		// backpropagation in a shared tree, which also removes the virtual loss of the path
+		static void backUpShared(MCTSNode* node, double result, const MCTSParameters& params);
+		void addVirtualLoss(const MCTSParameters& params);
+		// adds the result to the shared statistics of the states of the path
+		static void backUpTranspositions(MCTSNode* node, double result, TranspositionTable<MCTSStatistics>& table);
 
 		// return action
 		int bestAction(MCTSParameters& params, std::mt19937& randomGenerator);
@@ -37,20 +67,45 @@ namespace SGA {
 		// helper functions
 		static double normalize(double aValue, double aMin, double aMax);
 		static double noise(double input, double epsilon, double random);
-		void applyActionToGameState(TBSForwardModel& forwardModel, TBSGameState& gameState, Action& action, MCTSParameters& params) const;
+		void applyActionToGameState(TBSForwardModel& forwardModel, TBSGameState& gameState, const Action& action, MCTSParameters& params) const;
 		void setDepth(int depth);
+		[[nodiscard]] bool isFullyExpanded() const { return expandedChildren.load(std::memory_order_acquire) >= actionSpace.size(); }
+		// Number of children the node can have with its current visits, the whole action space unless progressive widening is enabled
+		[[nodiscard]] size_t allowedChildren(const MCTSParameters& params);
+		[[nodiscard]] bool canExpand(const MCTSParameters& params) { return expandedChildren.load(std::memory_order_acquire) < allowedChildren(params); }
+		// Moves the action of the next child to its index in the action space, according to the WIDENING_PRIOR
+		void drawNextAction(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator, TBSGameState& state);
+		void sortActionsByHeuristic(TBSForwardModel& forwardModel, MCTSParameters& params, const TBSGameState& state);
+
+		// Returns the state of the node, it is replayed from the closest ancestor with a state if the node did not keep it
+		TBSGameState getGameState(TBSForwardModel& forwardModel, MCTSParameters& params) const;
+		// Replays and keeps the state of a node that becomes the root of a continued search
+		void restoreState(TBSForwardModel& forwardModel, MCTSParameters& params);
 
 	public:
-		// Root Node Constructor
-		MCTSNode(TBSForwardModel& forwardModel, TBSGameState gameState);
+		// Root Node Constructor, roots are created with NodeArena::createRoot
+		MCTSNode(NodeArena<MCTSNode>& arena, TBSForwardModel& forwardModel, TBSGameState gameState);
+		// Root Node Constructor for a search over the given actions
+		MCTSNode(NodeArena<MCTSNode>& arena, TBSGameState gameState, std::vector<Action> actionSpace);
 
 		//void setRootGameState(shared_ptr<TreeNode> root);
 		void searchMCTS(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator);
+		// Selects EVALUATION_BATCH_SIZE leaves, rates them at once and backs up their results, until the budget is used up
+		void searchMCTSBatched(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator);
 		int mostVisitedAction(MCTSParameters& params, std::mt19937& randomGenerator);
+		// Sums up the statistics of the children of all roots, the roots have to search the same actions, but may have expanded them in a different order
+		// Returns the index of the selected action in the action space of the first root
+		static int mostVisitedAction(const std::vector<MCTSNode*>& roots, MCTSParameters& params, std::mt19937& randomGenerator);
 		void print() const override;
 
 	private:
-		MCTSNode(TBSForwardModel& forwardModel, TBSGameState gameState, MCTSNode* parent, int childIndex);
+		friend class ITreeNode<MCTSNode>;
+		MCTSNode(NodeArena<MCTSNode>& arena, TBSForwardModel& forwardModel, TBSGameState gameState, MCTSNode* parent, int childIndex);
+
+		// Moves the state out of the node, only isGameOver and currentPlayer are left
+		TBSGameState releaseState();
+
+		static int bestAction(const std::vector<int>& childVisits, const std::vector<double>& childValues, MCTSParameters& params, std::mt19937& randomGenerator);
 		
 	};
 }
\ No newline at end of file
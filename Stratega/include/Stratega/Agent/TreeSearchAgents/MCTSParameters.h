@@ -4,8 +4,29 @@
 #include <Stratega/Agent/Heuristic/StateHeuristic.h>
 #include <Stratega/Agent/Heuristic/MinimizeDistanceHeuristic.h>
 #include <Stratega/Agent/AgentParameters.h>
+#include <Stratega/Agent/TreeSearchAgents/TranspositionTable.h>
 
 namespace SGA {
+    // Decides which of the unexpanded actions of a node becomes its next child
+    enum class WideningPrior
+    {
+        // The actions are expanded in the order of the action space, or in random order with progressive widening
+        None,
+        // The action chosen by the widening script among the unexpanded actions is expanded next
+        Script,
+        // All actions are applied once and expanded in the order of the value the heuristic gives their state, costs one forward model call per action
+        Heuristic
+    };
+
+    // Statistics of all nodes with the same state, shared through the transposition table
+    struct MCTSStatistics
+    {
+        int visits = 0;
+        double value = 0;
+
+        int getPriority() const { return visits; }
+    };
+
     struct MCTSParameters : AgentParameters
 	{
         double K = sqrt(2);
@@ -17,17 +38,86 @@ namespace SGA {
     	
         bool CONTINUE_PREVIOUS_SEARCH = true;
 
+        // Number of threads searching in parallel, each gets its own part of the forward model calls
+        int THREADS = 1;
+        // If set, all threads search one shared tree (tree parallelization), otherwise each thread searches its own tree (root parallelization)
+        bool SHARED_TREE = false;
+        // Visits without reward added to the nodes a thread selects in a shared tree, so that the other threads prefer different paths until its result is backed up
+        int VIRTUAL_LOSS = 1;
+        // Number of leaves a thread selects before their states are rated at once with StateHeuristic::evaluateBatch
+        // The selected paths get a virtual loss as in a shared tree, so that the leaves of a batch differ
+        int EVALUATION_BATCH_SIZE = 1;
+
+        // If set, nodes do not keep their state, it is rebuilt by replaying the actions from the closest ancestor that kept one
+        // This costs additional forward model calls, but the tree needs a fraction of the memory
+        bool REPLAY_STATES = false;
+        // With REPLAY_STATES a node keeps its state if the closest ancestor with a state is this many actions away, 0 only keeps the state of the root
+        int CHECKPOINT_INTERVAL = 4;
+
+        // Maximum number of states in the transposition table, which lets uct use the statistics of all nodes with the same state, 0 disables it
+        // Every tree gets its own table, except a shared tree, which does not use one
+        int TRANSPOSITION_TABLE_SIZE = 0;
+        // The table of the searched tree, set by the agent
+        TranspositionTable<MCTSStatistics>* transpositionTable = nullptr;
+
+        // Progressive widening: a node can have ceil(WIDENING_K * visits^WIDENING_ALPHA) children, uct selects among them once they are expanded
+        // 0 disables it, so all actions are expanded before uct selects a child
+        double WIDENING_K = 0;
+        double WIDENING_ALPHA = 0.5;
+        WideningPrior WIDENING_PRIOR = WideningPrior::None;
+        // Shared by the trees of a parallel search, like the heuristic
+        std::shared_ptr<BaseActionScript> wideningScript = std::make_shared<RandomActionScript>();
+
         std::uniform_real_distribution<double> doubleDistribution_ = std::uniform_real_distribution<double>(0, 1);
 
-        std::unique_ptr<StateHeuristic> STATE_HEURISTIC = std::make_unique<MinimizeDistanceHeuristic>();
-        std::unique_ptr<BaseActionScript> opponentModel = std::make_unique<RandomActionScript>();	// the portfolio the opponent is simulated with, if set to nullptr the opponent's turn will be skipped
+        // Shared by the trees of a parallel search, so they have to be safe to use from several threads
+        std::shared_ptr<StateHeuristic> STATE_HEURISTIC = std::make_shared<MinimizeDistanceHeuristic>();
+        std::shared_ptr<BaseActionScript> opponentModel = std::make_shared<RandomActionScript>();	// the portfolio the opponent is simulated with, if set to nullptr the opponent's turn will be skipped
 
+        /// <summary>
+        /// Copies the parameters of the search for one thread of a parallel search, the thread gets the given forward model calls.
+        /// The budget of the thread is started, its time is measured from the start of this budget.
+        /// The heuristic and the opponent model are shared with this object.
+        /// </summary>
+        MCTSParameters createThreadParameters(int fmCalls) const;
+        // Whether the selected paths get a virtual loss until their result is backed up
+        [[nodiscard]] bool usesVirtualLoss() const { return SHARED_TREE || EVALUATION_BATCH_SIZE > 1; }
         void printDetails() const;
     };
 }
 
 namespace YAML
 {	
+    template<>
+    struct convert<SGA::WideningPrior>
+    {
+        static bool decode(const Node& node, SGA::WideningPrior& rhs)
+        {
+            if (!node.IsScalar())
+                return false;
+
+            auto type = node.as<std::string>();
+            if (type == "None")
+            {
+                rhs = SGA::WideningPrior::None;
+            }
+            else if (type == "Script")
+            {
+                rhs = SGA::WideningPrior::Script;
+            }
+            else if (type == "Heuristic")
+            {
+                rhs = SGA::WideningPrior::Heuristic;
+            }
+            else
+            {
+                return false;
+            }
+
+            return true;
+        }
+    };
+
     template<>
     struct convert<SGA::MCTSParameters>
     {
@@ -36,8 +126,17 @@ namespace YAML
             rhs.K = node["K"].as<double>(rhs.K);
             rhs.ROLLOUT_LENGTH= node["RolloutLength"].as<int>(rhs.ROLLOUT_LENGTH);
             rhs.ROLLOUTS_ENABLED = node["EnableRollouts"].as<bool>(rhs.ROLLOUTS_ENABLED);
-        	rhs.MAX_FM_CALLS = node["FmCalls"].as<int>(rhs.MAX_FM_CALLS);
-            rhs.REMAINING_FM_CALLS = rhs.MAX_FM_CALLS;
+            convert<SGA::SearchBudget>::decode(node, rhs);
+            rhs.THREADS = node["Threads"].as<int>(rhs.THREADS);
+            rhs.SHARED_TREE = node["SharedTree"].as<bool>(rhs.SHARED_TREE);
+            rhs.VIRTUAL_LOSS = node["VirtualLoss"].as<int>(rhs.VIRTUAL_LOSS);
+            rhs.EVALUATION_BATCH_SIZE = node["EvaluationBatchSize"].as<int>(rhs.EVALUATION_BATCH_SIZE);
+            rhs.REPLAY_STATES = node["ReplayStates"].as<bool>(rhs.REPLAY_STATES);
+            rhs.CHECKPOINT_INTERVAL = node["CheckpointInterval"].as<int>(rhs.CHECKPOINT_INTERVAL);
+            rhs.TRANSPOSITION_TABLE_SIZE = node["TranspositionTableSize"].as<int>(rhs.TRANSPOSITION_TABLE_SIZE);
+            rhs.WIDENING_K = node["WideningK"].as<double>(rhs.WIDENING_K);
+            rhs.WIDENING_ALPHA = node["WideningAlpha"].as<double>(rhs.WIDENING_ALPHA);
+            rhs.WIDENING_PRIOR = node["WideningPrior"].as<SGA::WideningPrior>(rhs.WIDENING_PRIOR);
             return true;
         }
     };
@@ -0,0 +1,122 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace SGA
+{
+	/// <summary>
+	/// Allocates the nodes of a search tree from large chunks instead of allocating every node on its own.
+	/// The children of a node are allocated as one contiguous block, so they can be stored as a range.
+	/// Clearing the tree keeps the chunks for the next tree, the nodes are never freed one by one.
+	/// </summary>
+	template<typename NodeType>
+	class NodeArena
+	{
+	public:
+		NodeArena(size_t chunkBytes = 1 << 18) :
+			nodesPerChunk(std::max<size_t>(1, chunkBytes / sizeof(NodeType)))
+		{
+		}
+
+		~NodeArena()
+		{
+			clear();
+			std::allocator<NodeType> allocator;
+			for (auto& chunk : chunks)
+				allocator.deallocate(chunk.nodes, chunk.capacity);
+		}
+
+		NodeArena(const NodeArena&) = delete;
+		NodeArena& operator=(const NodeArena&) = delete;
+
+		// Destroys the current tree and creates the root of a new one, the arguments are passed after the arena
+		template<typename... Args>
+		NodeType* createRoot(Args&&... args)
+		{
+			clear();
+			root = new (allocate(1)) NodeType(*this, std::forward<Args>(args)...);
+			return root;
+		}
+
+		/// <summary>
+		/// Makes a node of the tree the new root and destroys all nodes outside of its subtree, so that their game states are freed right away.
+		/// The memory of the destroyed nodes is only reused after the next clear.
+		/// </summary>
+		void setRoot(NodeType* node)
+		{
+			NodeType* keep = node;
+			NodeType* parent = node->parentNode;
+			while (parent != nullptr)
+			{
+				for (auto& child : parent->children)
+				{
+					if (&child != keep)
+						child.~NodeType();
+				}
+				parent->children = {};
+
+				NodeType* next = parent->parentNode;
+				// the old root is destroyed here as well, the other ancestors are skipped when destroying the children of their parent
+				parent->~NodeType();
+				keep = parent;
+				parent = next;
+			}
+
+			node->parentNode = nullptr;
+			root = node;
+		}
+
+		// Returns uninitialized memory for count consecutive nodes, can be called by several threads at once
+		NodeType* allocate(size_t count)
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			while (currentChunk < chunks.size() && chunks[currentChunk].capacity - usedNodes < count)
+			{
+				currentChunk++;
+				usedNodes = 0;
+			}
+
+			if (currentChunk == chunks.size())
+			{
+				const size_t capacity = std::max(count, nodesPerChunk);
+				chunks.emplace_back(Chunk{ std::allocator<NodeType>().allocate(capacity), capacity });
+			}
+
+			NodeType* nodes = chunks[currentChunk].nodes + usedNodes;
+			usedNodes += count;
+			return nodes;
+		}
+
+		/// <summary>
+		/// Destroys all nodes created since the last root, including the ones outside of a subtree that became the new root.
+		/// The memory is reused by the next tree.
+		/// </summary>
+		void clear()
+		{
+			if (root != nullptr)
+			{
+				root->~NodeType();
+				root = nullptr;
+			}
+			currentChunk = 0;
+			usedNodes = 0;
+		}
+
+	private:
+		struct Chunk
+		{
+			NodeType* nodes;
+			size_t capacity;
+		};
+
+		size_t nodesPerChunk;
+		std::vector<Chunk> chunks;
+		size_t currentChunk = 0;
+		size_t usedNodes = 0;
+		NodeType* root = nullptr;
+		std::mutex mutex;
+	};
+}
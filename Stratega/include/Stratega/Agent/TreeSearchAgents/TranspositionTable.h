@@ -0,0 +1,104 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace SGA
+{
+	/// <summary>
+	/// Stores a value per state hash in a fixed number of entries, so that searches can share information between transpositions.
+	/// A hash maps to a bucket of a few entries. If the bucket is full, a new hash replaces an entry of an older generation first,
+	/// then the entry with the lowest priority. ValueType has to be default constructible and provide int getPriority() const.
+	/// Not thread-safe, every tree of a parallel search needs its own table.
+	/// </summary>
+	template<typename ValueType>
+	class TranspositionTable
+	{
+	public:
+		explicit TranspositionTable(size_t maxEntries)
+		{
+			size_t bucketCount = 1;
+			while (bucketCount * BUCKET_SIZE < maxEntries)
+				bucketCount *= 2;
+
+			entries.resize(bucketCount * BUCKET_SIZE);
+			bucketMask = bucketCount - 1;
+		}
+
+		// Returns the value stored for the hash, or nullptr if it is not in the table
+		ValueType* find(std::uint64_t hash)
+		{
+			Entry* bucket = getBucket(hash);
+			for (size_t i = 0; i < BUCKET_SIZE; i++)
+			{
+				if (bucket[i].used && bucket[i].hash == hash)
+				{
+					bucket[i].generation = generation;
+					return &bucket[i].value;
+				}
+			}
+			return nullptr;
+		}
+
+		// Returns the value stored for the hash, a new value is default constructed and may replace the value of another hash
+		ValueType& insert(std::uint64_t hash)
+		{
+			Entry* bucket = getBucket(hash);
+			Entry* replaced = nullptr;
+			for (size_t i = 0; i < BUCKET_SIZE; i++)
+			{
+				Entry& entry = bucket[i];
+				if (entry.used && entry.hash == hash)
+				{
+					entry.generation = generation;
+					return entry.value;
+				}
+
+				if (replaced == nullptr || isReplacedBefore(entry, *replaced))
+					replaced = &entry;
+			}
+
+			replaced->hash = hash;
+			replaced->generation = generation;
+			replaced->used = true;
+			replaced->value = ValueType();
+			return replaced->value;
+		}
+
+		// Entries that are not found or inserted after this call are replaced before the others
+		void newGeneration() { generation++; }
+
+		void clear()
+		{
+			for (auto& entry : entries)
+				entry.used = false;
+		}
+
+		size_t getCapacity() const { return entries.size(); }
+
+	private:
+		static const size_t BUCKET_SIZE = 4;
+
+		struct Entry
+		{
+			std::uint64_t hash = 0;
+			unsigned int generation = 0;
+			bool used = false;
+			ValueType value;
+		};
+
+		Entry* getBucket(std::uint64_t hash) { return &entries[(hash & bucketMask) * BUCKET_SIZE]; }
+
+		bool isReplacedBefore(const Entry& entry, const Entry& other) const
+		{
+			if (entry.used != other.used)
+				return !entry.used;
+			if (entry.generation != other.generation)
+				return entry.generation < other.generation;
+			return entry.value.getPriority() < other.value.getPriority();
+		}
+
+		std::vector<Entry> entries;
+		std::uint64_t bucketMask;
+		unsigned int generation = 0;
+	};
+}
@@ -2,19 +2,40 @@
 #include <Stratega/Agent/TreeSearchAgents/ITreeNode.h>
 #include <Stratega/Agent/AgentParameters.h>
 
+#include <cstdint>
+#include <random>
+
 namespace SGA {
 
 	class TreeNode : public ITreeNode<TreeNode>
 	{
-		TreeNode(TBSForwardModel& forwardModel, TBSGameState gameState, TreeNode* parent, int childIndex);
+		friend class ITreeNode<TreeNode>;
+		TreeNode(NodeArena<TreeNode>& arena, TBSForwardModel& forwardModel, TBSGameState gameState, TreeNode* parent, int childIndex);
 
 	public:
-		// Root Node Constructor
-		TreeNode(TBSForwardModel& forwardModel, TBSGameState gameState);
-		TreeNode* expand(TBSForwardModel& forwardModel, AgentParameters& agentParameters);
+		// A node can release its state and replay it later, only its isGameOver and currentPlayer stay valid in the meantime
+		bool hasState = true;
+		// Seed of the random action scripts while the action of the node is applied, so that replaying it gives the same state
+		unsigned int transitionSeed = 0;
+		// Only set by searches that use a transposition table
+		std::uint64_t stateHash = 0;
+
+		// Root Node Constructor, roots are created with NodeArena::createRoot
+		TreeNode(NodeArena<TreeNode>& arena, TBSForwardModel& forwardModel, TBSGameState gameState);
+		// If a seed generator is given, the transition is seeded with its next value, so that the child can release its state and replay it
+		TreeNode* expand(TBSForwardModel& forwardModel, AgentParameters& agentParameters, std::mt19937* seedGenerator = nullptr);
+
+		// Returns the state of the node, it is replayed from the closest ancestor with a state if the node released it
+		TBSGameState getGameState(TBSForwardModel& forwardModel, AgentParameters& agentParameters) const;
+		void restoreState(TBSForwardModel& forwardModel, AgentParameters& agentParameters);
+		void releaseState();
 		
 		//std::string toString() const override;
 		void print() const override;
+
+	private:
+		// Applies the action and lets the opponent play until it is the agent's turn again
+		static void applyActionToGameState(TBSForwardModel& forwardModel, TBSGameState& gameState, const Action& action, AgentParameters& agentParameters);
 	};	
 
 }
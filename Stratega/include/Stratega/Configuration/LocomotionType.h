@@ -0,0 +1,32 @@
+#pragma once
+#include <Stratega/Configuration/YamlHeaders.h>
+#include <Stratega/ForwardModel/RTSForwardModel.h>
+
+namespace YAML
+{
+    template<>
+    struct convert<SGA::LocomotionType>
+    {
+        static bool decode(const Node& node, SGA::LocomotionType& rhs)
+        {
+            if (!node.IsScalar())
+                return false;
+
+            auto type = node.as<std::string>();
+            if (type == "Steering")
+            {
+                rhs = SGA::LocomotionType::Steering;
+            }
+            else if(type=="Crowd")
+            {
+                rhs = SGA::LocomotionType::Crowd;
+            }
+            else
+            {
+                return false;
+            }
+
+            return true;
+        }
+    };
+}
\ No newline at end of file
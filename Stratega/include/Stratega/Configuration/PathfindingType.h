@@ -0,0 +1,36 @@
+#pragma once
+#include <Stratega/Configuration/YamlHeaders.h>
+#include <Stratega/ForwardModel/RTSForwardModel.h>
+
+namespace YAML
+{
+    template<>
+    struct convert<SGA::PathfindingType>
+    {
+        static bool decode(const Node& node, SGA::PathfindingType& rhs)
+        {
+            if (!node.IsScalar())
+                return false;
+
+            auto type = node.as<std::string>();
+            if (type == "Navmesh")
+            {
+                rhs = SGA::PathfindingType::Navmesh;
+            }
+            else if(type=="FlowField")
+            {
+                rhs = SGA::PathfindingType::FlowField;
+            }
+            else if(type=="Grid")
+            {
+                rhs = SGA::PathfindingType::Grid;
+            }
+            else
+            {
+                return false;
+            }
+
+            return true;
+        }
+    };
+}
\ No newline at end of file
@@ -46,6 +46,13 @@ namespace SGA
 		
 		void execute(GameState& state, const EntityForwardModel& fm) const;
 
+		// Actions are equal if they execute the same action type with the same targets, the elapsed ticks of a continuous action are ignored
+		bool operator==(const Action& other) const
+		{
+			return actionTypeFlags == other.actionTypeFlags && actionTypeID == other.actionTypeID && ownerID == other.ownerID
+				&& continuousActionID == other.continuousActionID && targets == other.targets;
+		}
+
 		static Action createEndAction(int playerID)
 		{
 			Action a;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <variant>
 #include <Stratega/Representation/Vector2.h>
@@ -64,6 +65,12 @@ namespace SGA
 			return targetType;
 		}
 
+		// Targets are equal if they have the same type and reference the same position, entity, player, etc.
+		bool operator==(const ActionTarget& other) const;
+		bool operator!=(const ActionTarget& other) const { return !(*this == other); }
+		// Hashes the referenced position, entity, player, etc., equal targets have the same hash
+		std::uint64_t getHash() const;
+
 	private:
 		union Data
 		{
@@ -34,6 +34,8 @@ namespace SGA
 		HasElapsedTime(const std::vector<FunctionParameter>& parameters);
 
 		bool isFullfilled(const GameState& state, const std::vector<ActionTarget>& targets) const override;
+		// Amount of ticks the continuous action has to run, used to predict when it completes
+		double getLowerBound(const GameState& state, const std::vector<ActionTarget>& targets) const;
 	};
 	
 	class SamePlayer : public Condition
@@ -5,32 +5,91 @@
 #include <Stratega/Representation/Path.h>
 
 #include <chrono>
+#include <filesystem>
 
 #include "DetourCommon.h"
 #include "DetourNavMeshBuilder.h"
 
 namespace  SGA
 {
+	enum class PathfindingType
+	{
+		Navmesh,	// Every unit follows its own Detour path
+		FlowField,	// Units moving to the same tile share a flow field
+		Grid		// Every unit follows its own path over the board tiles (HPA* and jump point search), no navmesh is built
+	};
+	
+	enum class LocomotionType
+	{
+		Steering,	// Units walk along their path and push each other apart
+		Crowd		// The units of the live game are moved as agents of a dtCrowd, this needs the navmesh
+	};
+	
 	class RTSForwardModel : public EntityForwardModel
 	{
 	public:
 		float deltaTime;
+		PathfindingType pathfinding;
+		LocomotionType locomotion;
+		CrowdConfig crowdConfig;
+		// Built navmeshes are also written to this directory and loaded from it in later runs, empty keeps them in memory only
+		std::filesystem::path navMeshCacheDirectory;
 		
 		RTSForwardModel()
-			: deltaTime(1. / 60.)
+			: deltaTime(1. / 60.),
+			  pathfinding(PathfindingType::Navmesh),
+			  locomotion(LocomotionType::Steering)
 		{
 		}
 
 		void advanceGameState(RTSGameState& state, const Action& action) const;
 
+		/// <summary>
+		/// Returns how many of the following ticks only count down timers (cooldowns, elapsed ticks of continuous actions).
+		/// Returns 0 if the next tick has to be simulated, for example because a unit is moving or a continuous action completes.
+		/// </summary>
+		int ticksUntilNextEvent(const RTSGameState& state) const;
+		/// <summary>
+		/// Skips up to maxTicks idle ticks in one step, stopping at the next tick in which anything can change.
+		/// Returns the number of ticks that were skipped.
+		/// </summary>
+		int fastForward(RTSGameState& state, int maxTicks) const;
+
 		std::vector<Action> generateActions(RTSGameState& state) const;
 		std::vector<Action> generateActions(RTSGameState& state, int playerID) const;
 
 		void resolveUnitCollisions(RTSGameState& state) const;
 		void resolveEnvironmentCollisions(RTSGameState& state) const;
+		bool hasPendingCollisions(const RTSGameState& state) const;
 
+		// Builds the GridPathfinder instead of the navmesh if the grid pathfinding is used
 		bool buildNavMesh(RTSGameState& state, NavigationConfig config) const;
+		/// <summary>
+		/// Marks the navmesh tiles covering the board position for a rebuild, call it when the walkability of a tile changed.
+		/// The tiles are rebuilt by updateNavMesh, with the grid pathfinding the clusters of the board position.
+		/// A state gets its own copy of a grid pathfinder shared with other copies of the state and of a navmesh of the NavigationCache.
+		/// A navmesh that was already copied is shared by the copies of the state made afterwards, they see each other's changes.
+		/// </summary>
+		void invalidateNavMesh(RTSGameState& state, const Vector2i& boardPosition) const;
+		// Dynamic obstacles that cut holes into the navmesh, they are applied by updateNavMesh. The grid pathfinding ignores them
+		dtObstacleRef addNavMeshObstacle(RTSGameState& state, const Vector2f& position, float radius) const;
+		void removeNavMeshObstacle(RTSGameState& state, dtObstacleRef obstacle) const;
+		/// <summary>
+		/// Rebuilds the invalidated tiles and the tiles touched by obstacles until the time budget is used up.
+		/// Returns true if the navmesh is up to date.
+		/// </summary>
+		bool updateNavMesh(RTSGameState& state, double maxMilliseconds) const;
 		Path findPath(const RTSGameState& state, Vector2f startPos, Vector2f endPos) const;
+		/// <summary>
+		/// Makes sure the unit has a path to targetPos. Uses the state's PathRequestQueue if available, otherwise calls findPath.
+		/// Returns true while the path is still being resolved, in the meantime the unit keeps its old path.
+		/// </summary>
+		bool updatePath(RTSGameState& state, Entity& unit, const Vector2f& targetPos) const;
+		/// <summary>
+		/// Returns the position the unit should walk to next according to the flow field of the target tile.
+		/// Returns targetPos once the unit reached the target tile or if the target is unreachable.
+		/// </summary>
+		Vector2f followFlowField(const RTSGameState& state, const Vector2f& position, const Vector2f& targetPos) const;
 
 		bool checkGameIsFinished(RTSGameState& state) const;
 	};
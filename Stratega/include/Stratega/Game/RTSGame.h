@@ -1,16 +1,33 @@
 #pragma once
 #include <mutex>
+#include <condition_variable>
+#include <unordered_set>
 #include <Stratega/Game/Game.h>
 #include <Stratega/Representation/RTSGameState.h>
 #include <Stratega/ForwardModel/RTSForwardModel.h>
 #include <random>
 namespace SGA
 {
+	/// <summary>
+	/// Diagnostics of a running RTSGame, replaces the per-second console output.
+	/// The per-second values are refreshed once per second of real time.
+	/// </summary>
+	struct RTSGameMetrics
+	{
+		int totalTicks = 0;
+		double simulatedTime = 0;
+		double realTime = 0;
+		int ticksLastSecond = 0;
+		double ticksPerSecond = 0;
+		double speedup = 0;
+	};
+	
 	class RTSGame final : public Game
 	{
 	private:
 		double accumulatedTimeUpdate = 0;
 		double accumulatedTimePrint = 0;
+		double elapsedRealTime = 0;
 		int executionCount = 0;
 		
 	public:
@@ -22,6 +39,8 @@ namespace SGA
 		void executeAction(Action action);
 		void update(double deltaTime) override;
 		void close() override;
+		void addCommunicator(std::shared_ptr<GameCommunicator> comm) override;
+		void removeLockstepPlayer(int playerID);
 		bool isGameOver() const override { return Game::isGameOver() || gameState->isGameOver; }
 		
 		const RTSForwardModel& getForwardModel() const { return forwardModel; }
@@ -33,22 +52,55 @@ namespace SGA
 		/// </summary>
 		const RTSGameState& getState() const;
 		RTSGameState getStateCopy();
+		// Reads the tick under the state lock, so that agents polling it do not have to copy the state
+		int getCurrentTick();
 
 		[[nodiscard]] bool isUpdatingState() const { return updatingState && !isGameOver(); }
 
+		/// <summary>
+		/// Returns a copy of the diagnostics collected while running the game.
+		/// </summary>
+		RTSGameMetrics getMetrics();
+
+		/// <summary>
+		/// Builds the navmesh of the running game, or takes it from the NavigationCache if the board was seen before.
+		/// </summary>
+		void buildNavMesh(NavigationConfig config);
+
 	private:
 		bool updatingState = false;
 
+		void advanceTick();
+		void updateMetrics(double deltaTime);
+		bool allPlayersFinishedTick();
+
 		std::unique_ptr<RTSGameState> gameState;
 		RTSForwardModel forwardModel;
 
 		std::mt19937 rngEngine;
 
 		std::mutex stateMutex;
+
+		RTSGameMetrics metrics;
+
+		// Lockstep synchronisation with the agents
+		std::mutex lockstepMutex;
+		std::condition_variable lockstepCondition;
+		std::unordered_set<int> lockstepPlayers;
+		std::unordered_set<int> finishedPlayers;
+		int lockstepTick = 0;
+		
 	public:
 		//Navmesh Update
 		NavigationConfig navigationConfig;
-		bool shouldUpdateNavmesh;
+		bool shouldUpdateNavmesh = true;
+		double navmeshUpdateBudget = 1;	// Milliseconds per tick spent on rebuilding invalidated navmesh tiles
 
+		//Simulation speed, has to be set before the game is running
+		double speedMultiplier = 1;	// Scales the real elapsed time, 2 runs the game twice as fast as real-time
+		bool unthrottled = false;	// Headless mode, advances the forwardModel as fast as possible ignoring the real elapsed time
+		bool lockstep = false;		// Only advances once every agent finished its tick by sending an EndTickAction
+		bool skipIdleTicks = false;	// Unthrottled only, fast-forwards ticks in which only cooldowns and timers change
+		int maxSkippedTicks = 60;	// Upper bound of ticks skipped at once, so agents still see the game progressing
 	};
 }
@@ -25,6 +25,11 @@ namespace SGA
 
 		std::mt19937& getRNGEngine() { return rngEngine; }
 		bool isGameOver() const;
+		/// <summary>
+		/// Checks if the game waits for this agent in every tick.
+		/// In lockstep mode the agent has to send an EndTickAction once it is done with the current tick.
+		/// </summary>
+		bool isLockstep() const;
 
 		//TODO private
 		void setGame(RTSGame& newGame);
@@ -34,6 +39,8 @@ namespace SGA
 		void executeAction(Action action) const;
 		bool isMyTurn() const;
 		RTSGameState getGameState() const;
+		// Cheaper than getGameState if only the tick is needed, for example to decide whether to act in lockstep mode
+		int getCurrentTick() const;
 
 	private:
 		RTSGame* game;
@@ -0,0 +1,76 @@
+#pragma once
+#include <Stratega/Representation/Navigation.h>
+#include <Stratega/Representation/Vector2.h>
+#include "DetourCrowd.h"
+
+#include <memory>
+#include <unordered_map>
+
+namespace SGA
+{
+	struct Entity;
+	struct RTSGameState;
+
+	struct CrowdConfig
+	{
+		int maxAgents = 256;
+		// Quality of the obstacle avoidance, from 0 (low) to 3 (high)
+		int avoidanceQuality = 3;
+		// How strongly agents keep their distance to each other
+		float separationWeight = 2;
+	};
+
+	/// <summary>
+	/// Moves the units of the game as agents of a dtCrowd, which follows their paths, keeps them apart and avoids other agents.
+	/// All agents are advanced by one dtCrowd::update per tick, replacing the path following of Move and the unit collisions.
+	/// Only entities that can move become agents, and only if the state has a navmesh.
+	/// </summary>
+	class CrowdSimulation
+	{
+	public:
+		CrowdSimulation(const CrowdConfig& config = CrowdConfig());
+		~CrowdSimulation();
+		CrowdSimulation(const CrowdSimulation& other) = delete;
+		CrowdSimulation& operator=(const CrowdSimulation& other) = delete;
+
+		/// <summary>
+		/// Adds the new entities of the state as agents and removes the agents of removed entities.
+		/// Has to be called at the start of every tick, before the units execute their actions.
+		/// </summary>
+		void sync(const RTSGameState& state);
+
+		bool isAgent(int entityID) const { return agents.find(entityID) != agents.end(); }
+		/// <summary>
+		/// Lets the agent of the unit walk to the target in the next update, agents not told to move in a tick stop.
+		/// Returns true once the unit arrived at the target.
+		/// </summary>
+		bool moveTo(const Entity& unit, const Vector2f& target);
+		// Advances all agents and writes their positions back to the entities
+		void update(RTSGameState& state, float deltaTime);
+		bool hasMovingAgents() const;
+
+		CrowdConfig config;
+
+	private:
+		struct Agent
+		{
+			int index;
+			Vector2f position;
+			Vector2f target;
+			bool hasTarget;
+			bool moveRequested;
+			// Ticks the agent stood still although it has a target
+			int blockedTicks;
+		};
+
+		bool init(const RTSGameState& state);
+		void addAgent(const Entity& entity);
+		bool canMove(const RTSGameState& state, int entityTypeID);
+
+		dtCrowd* crowd;
+		std::shared_ptr<Navigation> navigation;
+		std::unordered_map<int, Agent> agents;
+		// Whether the entity type has an action with a Move effect
+		std::unordered_map<int, bool> movableTypes;
+	};
+}
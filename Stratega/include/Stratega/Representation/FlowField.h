@@ -0,0 +1,61 @@
+#pragma once
+#include <Stratega/Representation/Grid2D.h>
+#include <Stratega/Representation/Tile.h>
+#include <Stratega/Representation/Vector2.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace SGA
+{
+	/// <summary>
+	/// Flow field towards a destination tile, shared by all units moving there.
+	/// The integration field contains the walking distance of every tile to the destination,
+	/// the direction field points every tile to its neighbour closest to the destination.
+	/// </summary>
+	class FlowField
+	{
+	public:
+		FlowField(const Grid2D<Tile>& board, const Vector2i& destination);
+
+		// Returns the next tile on the way to the destination, or false if the destination is reached or unreachable
+		bool getNextTile(const Vector2f& position, Vector2i& nextTile) const;
+		bool isReachable(const Vector2i& tile) const;
+
+		const Vector2i& getDestination() const { return destination; }
+		float getDistance(const Vector2i& tile) const { return integrationField[tile.y * width + tile.x]; }
+		const Vector2i& getDirection(const Vector2i& tile) const { return directionField[tile.y * width + tile.x]; }
+
+	private:
+		Vector2i destination;
+		int width;
+		int height;
+		std::vector<float> integrationField;
+		std::vector<Vector2i> directionField;
+	};
+
+	/// <summary>
+	/// Caches the flow fields of the most recently used destinations.
+	/// The fields depend on the walkability of the board, the cache has to be cleared when it changes.
+	/// Thread-safe, fields stay valid for their users even if they are evicted.
+	/// </summary>
+	class FlowFieldCache
+	{
+	public:
+		FlowFieldCache(size_t capacity = 32);
+
+		std::shared_ptr<const FlowField> getFlowField(const Grid2D<Tile>& board, const Vector2i& destination);
+		void clear();
+
+		size_t capacity;
+
+	private:
+		std::mutex mutex;
+		// Most recently used field first
+		std::list<std::shared_ptr<const FlowField>> fields;
+		std::unordered_map<Vector2i, std::list<std::shared_ptr<const FlowField>>::iterator> lookup;
+	};
+}
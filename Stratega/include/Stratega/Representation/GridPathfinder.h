@@ -0,0 +1,95 @@
+#pragma once
+#include <Stratega/Representation/Grid2D.h>
+#include <Stratega/Representation/Tile.h>
+#include <Stratega/Representation/Vector2.h>
+
+#include <vector>
+
+namespace SGA
+{
+	/// <summary>
+	/// Pathfinding on the tiles of the board, an alternative to the navmesh for tile maps.
+	/// The board is split into square clusters, which are connected by entrances on their borders (HPA*).
+	/// A search first finds the entrances to pass on the abstract graph and then finds the tiles between them with jump point search.
+	/// Units move in 8 directions and never cut the corners of un-walkable tiles, the same as with flow fields.
+	/// </summary>
+	class GridPathfinder
+	{
+	public:
+		GridPathfinder(const Grid2D<Tile>& board, int clusterSize = 16);
+		// Copies the clusters including the ones waiting for an update, so that a state can change its walkability on its own
+		GridPathfinder(const GridPathfinder& other) = default;
+
+		/// <summary>
+		/// Returns the corners of a path from the start to the end tile, starting with start and ending with end.
+		/// Corners visible from each other are merged, so the unit can walk straight from one to the next.
+		/// Returns false if the end is not reachable.
+		/// </summary>
+		bool findPath(const Vector2i& start, const Vector2i& end, std::vector<Vector2i>& corners) const;
+
+		// Marks the cluster of the tile for an update, call it when the walkability of the tile changed
+		void invalidate(const Vector2i& tile);
+		// Copies the walkability of the invalidated clusters from the board and rebuilds them and the entrances to their neighbours
+		void update(const Grid2D<Tile>& board);
+		bool isUpToDate() const { return dirtyClusters.empty(); }
+
+		bool isWalkable(const Vector2i& tile) const;
+		int getClusterSize() const { return clusterSize; }
+		int getEntranceCount() const;
+
+	private:
+		struct Entrance
+		{
+			Vector2i position;
+			// Tiles of the neighbouring clusters reachable in one step
+			std::vector<Vector2i> transitions;
+		};
+
+		struct Cluster
+		{
+			Vector2i min;
+			Vector2i max;
+			std::vector<Entrance> entrances;
+			// Walking distance between every pair of entrances inside the cluster, infinity if not connected
+			std::vector<float> distances;
+			// Node of the first entrance in the abstract graph, the entrances of a cluster are numbered consecutively
+			int firstNode = 0;
+		};
+
+		// Walkability of a cluster surrounded by un-walkable tiles, so that searches inside the cluster need no bounds checks
+		struct ClusterGrid
+		{
+			Vector2i origin;
+			int width;
+			std::vector<unsigned char> walkable;
+
+			int toIndex(const Vector2i& tile) const { return (tile.y - origin.y) * width + tile.x - origin.x; }
+			Vector2i toTile(int index) const { return Vector2i(origin.x + index % width, origin.y + index / width); }
+		};
+
+		int getClusterIndex(const Vector2i& tile) const { return (tile.y / clusterSize) * clusterCountX + tile.x / clusterSize; }
+		bool isWalkable(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height && walkable[y * width + x]; }
+
+		void buildCluster(int clusterIndex);
+		void numberNodes();
+		void addTransitions(Cluster& cluster, Vector2i start, const Vector2i& direction, const Vector2i& offset, int length);
+		ClusterGrid getClusterGrid(const Cluster& cluster) const;
+		// Walking distances from the tile to all tiles of the cluster, indexed like the ClusterGrid
+		static void computeDistances(const ClusterGrid& grid, const Vector2i& from, std::vector<float>& distances);
+		// Jump points of a path inside the cluster
+		static bool jumpPointSearch(const ClusterGrid& grid, const Vector2i& start, const Vector2i& end, std::vector<Vector2i>& path);
+		bool hasLineOfSight(const Vector2i& from, const Vector2i& to) const;
+
+		int width;
+		int height;
+		int clusterSize;
+		int clusterCountX;
+		int clusterCountY;
+		std::vector<unsigned char> walkable;
+		std::vector<Cluster> clusters;
+		// Index of the entrance in its cluster for every tile, -1 if the tile is no entrance
+		std::vector<int> entranceIndices;
+		int nodeCount;
+		std::vector<int> dirtyClusters;
+	};
+}
@@ -1,10 +1,23 @@
 #pragma once
 #include <Stratega/Representation/BuildContext.h>
+#include <Stratega/Representation/FlowField.h>
+#include <Stratega/Representation/GridPathfinder.h>
 #include "DetourCommon.h"
 #include "Recast.h"
 #include "DetourNavMesh.h"
+#include "DetourNavMeshQuery.h"
+#include "DetourTileCache.h"
+#include "DetourTileCacheBuilder.h"
 #include "DetourDebugDraw.h"
 
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
 /// These are just sample areas
 enum SamplePolyAreas
 {
@@ -48,7 +61,12 @@ namespace SGA
 			m_detailSampleDist = 6.0f;
 			m_detailSampleMaxError = 1.0f;
 			m_partitionType = SAMPLE_PARTITION_WATERSHED;
+			m_tileSize = 32;
+			m_gridClusterSize = 16;
 
+			m_filterLowHangingObstacles = false;
+			m_filterLedgeSpans = false;
+			m_filterWalkableLowHeightSpans = false;
 			m_erodeWalkableArea = false;
 		}
 
@@ -67,6 +85,10 @@ namespace SGA
 		float m_detailSampleDist;
 		float m_detailSampleMaxError;
 		int m_partitionType;
+		// Width and height of a navmesh tile in cells, a walkability change only rebuilds the affected tiles
+		int m_tileSize;
+		// Width and height of a cluster of the GridPathfinder in board tiles
+		int m_gridClusterSize;
 
 		//Filter stuff
 		bool m_filterLowHangingObstacles;
@@ -92,21 +114,112 @@ namespace SGA
 			m_detailSampleDist = 6.0f;
 			m_detailSampleMaxError = 1.0f;
 			m_partitionType = SAMPLE_PARTITION_WATERSHED;
+			m_tileSize = 32;
+			m_gridClusterSize = 16;
+			m_filterLowHangingObstacles = false;
+			m_filterLedgeSpans = false;
+			m_filterWalkableLowHeightSpans = false;
 			m_erodeWalkableArea = false;
 		}
 	};
 	
+	// Leaves the tiles of the tile cache uncompressed, we only need the tile cache for its incremental updates
+	struct NavigationTileCompressor : public dtTileCacheCompressor
+	{
+		int maxCompressedSize(const int bufferSize) override;
+		dtStatus compress(const unsigned char* buffer, const int bufferSize, unsigned char* compressed, const int maxCompressedSize, int* compressedSize) override;
+		dtStatus decompress(const unsigned char* compressed, const int compressedSize, unsigned char* buffer, const int maxBufferSize, int* bufferSize) override;
+	};
+
+	// Assigns the walk flag to the polygons built by the tile cache
+	struct NavigationMeshProcess : public dtTileCacheMeshProcess
+	{
+		void process(dtNavMeshCreateParams* params, unsigned char* polyAreas, unsigned short* polyFlags) override;
+	};
+	
+	/// <summary>
+	/// Hands out dtNavMeshQuery objects, a query keeps internal node pools and can only be used by one thread at a time.
+	/// Released queries are reused, so the pool only grows to the number of threads searching at the same time.
+	/// </summary>
+	class NavMeshQueryPool
+	{
+	public:
+		struct Releaser
+		{
+			NavMeshQueryPool* pool;
+			void operator()(dtNavMeshQuery* query) const { pool->release(query); }
+		};
+		// Returns the query to the pool when it goes out of scope
+		using Query = std::unique_ptr<dtNavMeshQuery, Releaser>;
+
+		NavMeshQueryPool() = default;
+		~NavMeshQueryPool() { clear(); }
+		NavMeshQueryPool(const NavMeshQueryPool& other) = delete;
+		NavMeshQueryPool& operator=(const NavMeshQueryPool& other) = delete;
+
+		bool init(const dtNavMesh* navMesh, int maxNodes);
+		// Returns nullptr if the pool is not initialized
+		Query acquire();
+		void clear();
+
+	private:
+		void release(dtNavMeshQuery* query);
+		dtNavMeshQuery* createQuery() const;
+
+		std::mutex poolMutex;
+		std::vector<dtNavMeshQuery*> freeQueries;
+		const dtNavMesh* navMesh = nullptr;
+		int maxNodes = 0;
+	};
+
+	/// <summary>
+	/// Reader-writer lock of the navmesh tiles, searches share it and tile rebuilds take it exclusively.
+	/// A waiting rebuild holds back new searches, otherwise the searches of the agent threads could starve it.
+	/// </summary>
+	class NavMeshLock
+	{
+	public:
+		void lock()
+		{
+			pendingRebuilds++;
+			mutex.lock();
+		}
+
+		void unlock()
+		{
+			mutex.unlock();
+			pendingRebuilds--;
+		}
+
+		void lock_shared()
+		{
+			while (pendingRebuilds.load() > 0)
+				std::this_thread::yield();
+			mutex.lock_shared();
+		}
+
+		void unlock_shared()
+		{
+			mutex.unlock_shared();
+		}
+
+	private:
+		std::shared_mutex mutex;
+		std::atomic<int> pendingRebuilds = 0;
+	};
+
 	class Navigation
 	{
 	public:
 		Navigation() :
-			m_solid(0),
-			m_chf(0),
-			m_cset(0),
-			m_pmesh(0),
-			m_dmesh(0),
 			m_navMesh(0),
-			m_navQuery(0)
+			m_tileCache(0),
+			m_tileCountX(0),
+			m_tileCountY(0),
+			m_shared(false),
+			m_obstaclesChanged(false),
+			m_cellCountX(0),
+			m_cellCountY(0)
 		{
 			m_filter.setIncludeFlags(SAMPLE_POLYFLAGS_ALL ^ SAMPLE_POLYFLAGS_DISABLED);
 			m_filter.setExcludeFlags(0);
@@ -119,38 +232,77 @@ namespace SGA
 			config.resetSettings();
 		}
 
+		~Navigation()
+		{
+			cleanup();
+		}
+
+		Navigation(const Navigation& other) = delete;
+		Navigation& operator=(const Navigation& other) = delete;
+
 		BuildContext m_ctx;
 
 		//Recast Stuff
-		rcHeightfield* m_solid;
-		rcCompactHeightfield* m_chf;
-		rcContourSet* m_cset;
-		rcPolyMesh* m_pmesh;
 		rcConfig m_cfg;
-		rcPolyMeshDetail* m_dmesh;
 
 		dtNavMesh* m_navMesh;
-		dtNavMeshQuery* m_navQuery;
+		// Queries over m_navMesh, acquire one per search instead of sharing a single query between threads
+		NavMeshQueryPool m_queryPool;
+		// Guards the tiles of m_navMesh, searches take a shared lock and tile rebuilds an exclusive one
+		NavMeshLock m_navMeshLock;
+
+		//Tile cache, rebuilds single tiles of the navmesh
+		dtTileCache* m_tileCache;
+		dtTileCacheAlloc m_tileAlloc;
+		NavigationTileCompressor m_tileCompressor;
+		NavigationMeshProcess m_tileMeshProcess;
+		int m_tileCountX;
+		int m_tileCountY;
+		// Tiles whose walkability changed and that wait to be rebuilt
+		std::deque<Vector2i> m_dirtyTiles;
+		// Set for navmeshes owned by the NavigationCache, they are shared between games and must not be modified
+		bool m_shared;
+		// Set while obstacles were added or removed that the tile cache did not apply yet
+		bool m_obstaclesChanged;
+		// Tiles touched by obstacles, their cells are looked up again once the tile cache applied the obstacles
+		std::deque<Vector2i> m_obstacleTiles;
+
+		// Polygon below the center of every board cell, 0 if the center is not on the navmesh
+		std::vector<dtPolyRef> m_cellPolys;
+		int m_cellCountX;
+		int m_cellCountY;
 
 		NavigationConfig config;
+		// Allocates the empty tile cache, navmesh, query pool and cell lookup, m_cfg has to be set before
+		bool init(const dtTileCacheParams& tileCacheParams, const dtNavMeshParams& navMeshParams);
+		// Fills the polygon lookup of all cells, or only of the cells covered by a navmesh tile after it was rebuilt
+		void updateCellPolys();
+		void updateCellPolys(int tx, int ty);
+		/// <summary>
+		/// Returns the polygon below pos and moves pos onto its surface.
+		/// Reads the polygon of the cell and only searches the navmesh around pos if the cell does not know the polygon.
+		/// </summary>
+		dtPolyRef findPoly(const dtNavMeshQuery& query, float* pos) const;
 		void cleanup()
 		{
-			rcFreeHeightField(m_solid);
-			m_solid = 0;
-			rcFreeCompactHeightfield(m_chf);
-			m_chf = 0;
-			rcFreeContourSet(m_cset);
-			m_cset = 0;
-			rcFreePolyMesh(m_pmesh);
-			m_pmesh = 0;
-			rcFreePolyMeshDetail(m_dmesh);
-			m_dmesh = 0;
+			dtFreeTileCache(m_tileCache);
+			m_tileCache = 0;
+			m_queryPool.clear();
 			dtFreeNavMesh(m_navMesh);
 			m_navMesh = 0;
+			m_dirtyTiles.clear();
+			m_obstacleTiles.clear();
+			m_cellPolys.clear();
 		}
 
 		//Detour Stuff
 		dtQueryFilter m_filter;
 		float m_polyPickExt[3];
+
+		//Flow fields of this walkability, shared by all copies of the state
+		FlowFieldCache flowFields;
+
+		// Only set for PathfindingType::Grid, which searches the board tiles instead of building a navmesh
+		std::unique_ptr<GridPathfinder> gridPathfinder;
 	};
 }
@@ -0,0 +1,41 @@
+#pragma once
+#include <Stratega/Representation/Navigation.h>
+#include <Stratega/Representation/Grid2D.h>
+#include <Stratega/Representation/Tile.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace SGA::NavigationCache
+{
+	/// <summary>
+	/// Hash of everything a navmesh is built from, the walkability of the board and the NavigationConfig.
+	/// </summary>
+	std::uint64_t computeKey(const Grid2D<Tile>& board, const NavigationConfig& config);
+
+	/// <summary>
+	/// Returns the navmesh built for the key, looking in memory first and then in the directory, an empty directory is skipped.
+	/// Returns nullptr if no navmesh was stored for the key yet.
+	/// The returned navmesh is shared by all games of the process and must not be modified, use copy for that.
+	/// Only the navmeshes still used by a game and the most recently used one are kept in memory.
+	/// </summary>
+	std::shared_ptr<Navigation> find(std::uint64_t key, const NavigationConfig& config, const std::filesystem::path& directory);
+
+	/// <summary>
+	/// Shares the navmesh with all games that ask for the key and writes it to the directory unless it is empty.
+	/// Returns the instance to use, which is an older one if another game stored the same key first.
+	/// </summary>
+	std::shared_ptr<Navigation> store(std::uint64_t key, std::shared_ptr<Navigation> navigation, const std::filesystem::path& directory);
+
+	// Copy of a navmesh that can be modified, obstacles are not copied
+	std::shared_ptr<Navigation> copy(const Navigation& navigation);
+
+	// The tile cache layers in binary form, the navmesh tiles are rebuilt from them when loading
+	std::vector<unsigned char> serialize(const Navigation& navigation);
+	std::shared_ptr<Navigation> deserialize(const std::vector<unsigned char>& data, const NavigationConfig& config);
+
+	// Drops the navmeshes kept in memory, the files in the cache directory are kept
+	void clear();
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include "DetourNavMesh.h"
 #include "Navigation.h"
+#include <Stratega/Representation/Vector2.h>
 
 
 namespace SGA
@@ -19,6 +20,13 @@ namespace SGA
 		int m_straightPathOptions = 0;
 		
 		int  currentPathIndex = 0;
+
+		//Position the path was requested for
+		Vector2f target;
+
+		//Asynchronous request of the next path, see PathRequestQueue
+		int pathRequest = -1;
+		Vector2f pathRequestTarget;
 	};
 	
 }
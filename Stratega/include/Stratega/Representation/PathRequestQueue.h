@@ -0,0 +1,62 @@
+#pragma once
+#include <Stratega/Representation/Navigation.h>
+#include <Stratega/Representation/Path.h>
+#include <Stratega/Representation/Vector2.h>
+#include "DetourPathQueue.h"
+
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
+namespace SGA
+{
+	/// <summary>
+	/// Resolves path requests asynchronously with Detour's dtPathQueue.
+	/// Each update spends at most maxIterationsPerTick pathfinder iterations, so large group move orders do not stall a tick.
+	/// Requests that do not fit into the dtPathQueue wait in a FIFO until a slot is free.
+	/// </summary>
+	class PathRequestQueue
+	{
+	public:
+		PathRequestQueue(int maxIterationsPerTick = 256);
+
+		/// <summary>
+		/// Queues a path from startPos to endPos. Returns the handle of the request, or -1 if one of the positions is not on the navmesh.
+		/// </summary>
+		int request(const std::shared_ptr<Navigation>& navigation, const Vector2f& startPos, const Vector2f& endPos);
+		void cancel(int handle);
+
+		/// <summary>
+		/// Returns DT_IN_PROGRESS while the request is pending, and DT_FAILURE | DT_INVALID_PARAM for unknown handles.
+		/// </summary>
+		dtStatus getRequestStatus(int handle) const;
+
+		/// <summary>
+		/// Builds the straight path of a finished request, starting at the current position of the unit.
+		/// The request is removed from the queue afterwards.
+		/// </summary>
+		bool getPathResult(int handle, const Vector2f& startPos, Path& path);
+
+		// Spends the iteration budget on the pending requests, has to be called once per tick
+		void update(const std::shared_ptr<Navigation>& navigation);
+
+		int maxIterationsPerTick;
+
+	private:
+		struct Request
+		{
+			int handle;
+			dtPathQueueRef ref;
+			dtPolyRef startRef;
+			dtPolyRef endRef;
+			float startPos[3];
+			float endPos[3];
+		};
+
+		dtPathQueue pathQueue;
+		std::shared_ptr<Navigation> navigation;
+		std::deque<Request> waitingRequests;
+		std::unordered_map<int, Request> submittedRequests;
+		int nextHandle;
+	};
+}
@@ -1,12 +1,18 @@
 #pragma once
 #include <Stratega/Representation/GameState.h>
+#include <Stratega/Representation/CrowdSimulation.h>
 #include <Stratega/Representation/Navigation.h>
+#include <Stratega/Representation/PathRequestQueue.h>
 
 namespace SGA
 {
 	struct RTSGameState : public GameState
 	{
 		std::shared_ptr<Navigation> navigation;
+		// Optional, if set paths are resolved asynchronously instead of inside Move. Copies of the state do not share it
+		std::unique_ptr<PathRequestQueue> pathRequests;
+		// Optional, if set the units are moved as agents of a dtCrowd. Copies of the state do not share it
+		std::unique_ptr<CrowdSimulation> crowd;
 
 		RTSGameState():
 			GameState()
@@ -19,5 +25,19 @@ namespace SGA
 		{
 
 		}
+
+		RTSGameState(const RTSGameState& other) :
+			GameState(other),
+			navigation(other.navigation)
+		{
+		}
+		RTSGameState(RTSGameState&& other) noexcept = default;
+		RTSGameState& operator=(const RTSGameState& other)
+		{
+			GameState::operator=(other);
+			navigation = other.navigation;
+			return *this;
+		}
+		RTSGameState& operator=(RTSGameState&& other) noexcept = default;
 	};
-}
\ No newline at end of file
+}
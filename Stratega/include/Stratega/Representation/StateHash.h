@@ -0,0 +1,18 @@
+#pragma once
+#include <Stratega/Representation/TBSGameState.h>
+
+#include <cstdint>
+
+namespace SGA
+{
+	/// <summary>
+	/// Hashes the parts of the state that actions change: the entities, the players, the tick and whether the game is over.
+	/// Entities are hashed independent of their order, so two action sequences that lead to the same position get the same hash.
+	/// The board and the types are not hashed, since the forward model does not change them during a game.
+	/// </summary>
+	std::uint64_t hashState(const GameState& state);
+	// Additionally hashes the player to move
+	std::uint64_t hashState(const TBSGameState& state);
+	// Hashes the action type, the owner and the targets, equal actions have the same hash
+	std::uint64_t hashAction(const Action& action);
+}
@@ -1,10 +1,28 @@
 #include <Stratega/Agent/ActionScripts/RandomActionScript.h>
 
+#include <random>
+
 namespace SGA
 {
+	namespace
+	{
+		thread_local std::mt19937 randomGenerator;
+
+		size_t randomIndex(size_t size)
+		{
+			std::uniform_int_distribution<size_t> distribution(0, size - 1);
+			return distribution(randomGenerator);
+		}
+	}
+
+	void RandomActionScript::setSeed(unsigned int seed)
+	{
+		randomGenerator.seed(seed);
+	}
+
 	Action RandomActionScript::getAction(TBSGameState& gameState, std::vector<Action>& actionSpace) const
 	{
-		return actionSpace[rand() % actionSpace.size()];
+		return actionSpace[randomIndex(actionSpace.size())];
 	}
 	
 	Action RandomActionScript::getActionForUnit(TBSGameState& gameState, std::vector<Action>& actionSpace, int unitID) const
@@ -24,6 +42,6 @@ namespace SGA
 		if (!suitableActions.empty())
 			return suitableActions.at(rand() % suitableActions.size());*/
 		
-		return actionSpace[rand() % actionSpace.size()];
+		return actionSpace[randomIndex(actionSpace.size())];
 	}
 }
@@ -7,6 +7,7 @@
 #include <Stratega/Agent/TreeSearchAgents/BeamSearchAgent.h>
 #include <Stratega/Agent/TreeSearchAgents/DFSAgent.h>
 #include <Stratega/Agent/TreeSearchAgents/MCTSAgent.h>
+#include <Stratega/Agent/TreeSearchAgents/AlphaBetaAgent.h>
 
 namespace SGA
 {
@@ -61,12 +62,13 @@ namespace SGA
 		// Register agents available in the Stratega framework
 		factory.registerAgent<DoNothingAgent>("DoNothingAgent");
 		factory.registerAgent<RandomAgent>("RandomAgent");
-		factory.registerAgent<BFSAgent>("BFSAgent");
-		factory.registerAgent<RHEAAgent>("RHEAAgent");
-		factory.registerAgent<OSLAAgent>("OSLAAgent");
-		factory.registerAgent<BeamSearchAgent>("BeamSearchAgent");
-		factory.registerAgent<DFSAgent>("DFSAgent");
+		factory.registerAgent<BFSAgent, BFSParameters>("BFSAgent");
+		factory.registerAgent<RHEAAgent, RHEAParams>("RHEAAgent");
+		factory.registerAgent<OSLAAgent, OSLAParameters>("OSLAAgent");
+		factory.registerAgent<BeamSearchAgent, BeamSearchParameters>("BeamSearchAgent");
+		factory.registerAgent<DFSAgent, DFSParameters>("DFSAgent");
 		factory.registerAgent<MCTSAgent, MCTSParameters>("MCTSAgent");
+		factory.registerAgent<AlphaBetaAgent, AlphaBetaParameters>("AlphaBetaAgent");
 		
 		return factory;
 	}
@@ -7,6 +7,7 @@ namespace SGA {
 		std::cout << "AgentParameters" << "\n";
 		std::cout << "\tMAX_FM_CALLS= " << MAX_FM_CALLS << "\n";
 		std::cout << "\tREMAINING_FM_CALLS = " << REMAINING_FM_CALLS << "\n";
+		std::cout << "\tMAX_TIME_MS = " << MAX_TIME_MS << "\n";
 		std::cout << "\tPLAYER_ID = " << PLAYER_ID << "\n";
 		std::cout << "\tOPPONENT_MODEL = " << PLAYER_ID << "\n";
 	}
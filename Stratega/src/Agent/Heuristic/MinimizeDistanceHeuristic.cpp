@@ -1,11 +1,48 @@
-#include <map>
-#include <set>
 #include <Stratega/Agent/Heuristic/MinimizeDistanceHeuristic.h>
 
+#include <cmath>
+
 namespace SGA
 {
+	namespace
+	{
+		// The opponents' positions are gathered in blocks on the stack, so that an evaluation does not allocate memory
+		constexpr size_t BLOCK_SIZE = 64;
+		constexpr size_t LANES = 8;
+
+		// Sums the Manhattan distances from (x, y) to the positions of a block, count has to be a multiple of LANES.
+		// The lanes are summed independently so that the compiler can vectorise the loop, the sums are exact as long as the positions lie on the grid
+		double sumOfBlockDistances(float x, float y, const float* xs, const float* ys, size_t count)
+		{
+			float lanes[LANES] = {};
+			for (size_t i = 0; i < count; i += LANES)
+			{
+				for (size_t lane = 0; lane < LANES; lane++)
+				{
+					lanes[lane] += std::abs(x - xs[i + lane]) + std::abs(y - ys[i + lane]);
+				}
+			}
+
+			double sum = 0;
+			for (float lane : lanes)
+				sum += lane;
+			return sum;
+		}
+	}
 
 	double MinimizeDistanceHeuristic::evaluateGameState(const TBSForwardModel& forwardModel, TBSGameState& gameState, int playerID)
+	{
+		return evaluate(gameState, playerID);
+	}
+
+	void MinimizeDistanceHeuristic::evaluateBatch(const TBSForwardModel& forwardModel, std::span<TBSGameState* const> gameStates, int playerID, std::span<double> values)
+	{
+		// the heuristic needs neither the forward model nor memory, so the batch is a plain loop without virtual calls
+		for (size_t i = 0; i < gameStates.size(); i++)
+			values[i] = evaluate(*gameStates[i], playerID);
+	}
+
+	double MinimizeDistanceHeuristic::evaluate(const TBSGameState& gameState, int playerID)
 	{
 		double score = 0.0;
 
@@ -17,36 +54,57 @@ namespace SGA
 				score += 1000;
 		}
 
-		std::map<int, Vector2f> positions;
-		std::set<int> opponentEntites = std::set<int>();
-		std::set<int> playerEntities = std::set<int>();
-
+		// only the average distance of the player's entity with the highest ID counts, the distances of the other entities are not summed up
+		const Entity* playerUnit = nullptr;
+		size_t playerEntities = 0;
+		size_t opponentEntities = 0;
 		for (const auto& entity : gameState.entities)
 		{
-			positions.emplace(entity.id, entity.position);
 			if (entity.ownerID != gameState.currentPlayer)
 			{
-				opponentEntites.insert(entity.id);
+				opponentEntities++;
 			}
 			else
 			{
-				playerEntities.insert(entity.id);
+				playerEntities++;
+				if (playerUnit == nullptr || entity.id > playerUnit->id)
+					playerUnit = &entity;
 			}
 		}
 
 		double sumOfAverageDistances = 0;
-		for (const auto& playerUnit : playerEntities)
+		if (playerUnit != nullptr)
 		{
+			const float x = playerUnit->position.x;
+			const float y = playerUnit->position.y;
+			float xs[BLOCK_SIZE];
+			float ys[BLOCK_SIZE];
+			size_t count = 0;
 			double sumOfDistances = 0;
-			auto a = positions[playerUnit];
-			for (int opponentUnit : opponentEntites)
+			for (const auto& entity : gameState.entities)
+			{
+				if (entity.ownerID == gameState.currentPlayer)
+					continue;
+
+				xs[count] = entity.position.x;
+				ys[count] = entity.position.y;
+				if (++count == BLOCK_SIZE)
+				{
+					sumOfDistances += sumOfBlockDistances(x, y, xs, ys, count);
+					count = 0;
+				}
+			}
+
+			// pad the last block with the unit's own position, its distance is zero
+			for (; count % LANES != 0; count++)
 			{
-				auto b = positions[opponentUnit];
-				sumOfDistances += abs(a.x - b.x) + abs(a.y - b.y);
+				xs[count] = x;
+				ys[count] = y;
 			}
-			sumOfAverageDistances = sumOfDistances / opponentEntites.size();
+			sumOfDistances += sumOfBlockDistances(x, y, xs, ys, count);
+			sumOfAverageDistances = sumOfDistances / opponentEntities;
 		}
-		score += sumOfAverageDistances / playerEntities.size();
+		score += sumOfAverageDistances / playerEntities;
 
 		return score;
 	}
@@ -1,10 +1,15 @@
 #include <Stratega/Agent/OSLAAgent.h>
 #include <Stratega/Agent/Heuristic/MinimizeDistanceHeuristic.h>
 
+#include <algorithm>
+
 namespace SGA
 {
 	void OSLAAgent::runTBS(TBSGameCommunicator& gameCommunicator, TBSForwardModel forwardModel)
 	{
+		if (parameters_.THREADS > 1 && threadPool_ == nullptr)
+			threadPool_ = std::make_unique<ThreadPool>(parameters_.THREADS);
+
 		while (!gameCommunicator.isGameOver())
 		{
 			if (gameCommunicator.isMyTurn())
@@ -14,20 +19,45 @@ namespace SGA
 					break;
 				auto actionSpace = forwardModel.generateActions(gameState);
 				MinimizeDistanceHeuristic heuristic;
-				double bestHeuristicValue = -std::numeric_limits<double>::max();
-				
-				int bestActionIndex = 0;
 				const int playerID = gameState.currentPlayer;
+				parameters_.startBudget();
+
+				// each action costs one forward model call, so a limit on them decides up front how many of the first actions are rated
+				// the first action is always rated, so that the best action is known
+				size_t ratedActions = actionSpace.size();
+				if (parameters_.MAX_FM_CALLS > 0)
+					ratedActions = std::min(ratedActions, static_cast<size_t>(std::max(1, parameters_.MAX_FM_CALLS)));
 
-				for (int i = 0; i < actionSpace.size(); i++)
+				std::vector<double> values(ratedActions, -std::numeric_limits<double>::max());
+				auto rateAction = [&](size_t i)
 				{
+					if (i > 0 && parameters_.isTimeExhausted())
+						return;
+
 					auto gsCopy(gameState);
-					
+					parameters_.consumeFMCalls(1);
 					forwardModel.advanceGameState(gsCopy, actionSpace.at(i));
-					const double value = heuristic.evaluateGameState(forwardModel, gsCopy, playerID);
-					if (value > bestHeuristicValue)
+					values[i] = heuristic.evaluateGameState(forwardModel, gsCopy, playerID);
+				};
+
+				if (threadPool_ != nullptr)
+				{
+					threadPool_->parallelFor(ratedActions, rateAction);
+				}
+				else
+				{
+					for (size_t i = 0; i < ratedActions; i++)
+						rateAction(i);
+				}
+
+				// ties go to the first action, no matter which thread finished first
+				double bestHeuristicValue = -std::numeric_limits<double>::max();
+				size_t bestActionIndex = 0;
+				for (size_t i = 0; i < values.size(); i++)
+				{
+					if (values[i] > bestHeuristicValue)
 					{
-						bestHeuristicValue = value;
+						bestHeuristicValue = values[i];
 						bestActionIndex = i;
 					}
 				}
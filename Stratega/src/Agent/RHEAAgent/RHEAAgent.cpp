@@ -1,11 +1,18 @@
 #include <Stratega/Agent/RHEAAgent/RHEAAgent.h>
 
+#include <algorithm>
+#include <numeric>
+#include <optional>
+
 
 namespace SGA
 {
 	
 	void RHEAAgent::runTBS(TBSGameCommunicator& gameCommunicator, TBSForwardModel forwardModel)
 	{
+        if (params_.THREADS > 1 && threadPool_ == nullptr)
+            threadPool_ = std::make_unique<ThreadPool>(params_.THREADS);
+
         while (!gameCommunicator.isGameOver())
         {
             if (gameCommunicator.isMyTurn())
@@ -16,7 +23,7 @@ namespace SGA
             	
                 auto actionSpace = forwardModel.generateActions(gameState);
 
-                params_.REMAINING_FM_CALLS = params_.MAX_FM_CALLS;  // reset number of available forward model calls
+                params_.startBudget();  // reset number of available forward model calls and start the clock
                 params_.PLAYER_ID = gameState.currentPlayer;        // todo move into agent initialization
 
                 // in case only one action is available the player turn ends
@@ -29,19 +36,20 @@ namespace SGA
                 else
                 {
                     auto& rnd = gameCommunicator.getRNGEngine();
+                    prefixCache_.reset(forwardModel, gameState, rnd(), params_.PREFIX_CACHE_SIZE);
 
                     // either shift previous population or initialize a new population
                     if (params_.CONTINUE_SEARCH && !pop_.empty())
                     {
-                        pop_ = shiftPopulation(forwardModel, gameState, rnd);
+                        pop_ = shiftPopulation(rnd);
                     }
                     else
                     {
-                        initializePopulation(forwardModel, gameState, rnd);
+                        initializePopulation(rnd);
                     }
 
                     // run rhea and return the best individual of the previous generation
-                    rheaLoop(forwardModel, gameState, rnd);
+                    rheaLoop(gameState, rnd);
                     gameCommunicator.executeAction(pop_[0].getActions().front());
                 }
             }
@@ -49,52 +57,54 @@ namespace SGA
     }
 
 
-    void RHEAAgent::initializePopulation(TBSForwardModel& forwardModel, TBSGameState& gameState, std::mt19937& randomGenerator)
+    void RHEAAgent::initializePopulation(std::mt19937& randomGenerator)
     {
         // create params_.POP_SIZE new random individuals
-        pop_.clear();
-        for (size_t i = 0; i < params_.POP_SIZE; i++) {
-            pop_.emplace_back(RHEAGenome(forwardModel, gameState, params_));
-        }
+        pop_ = createGenomes(params_.POP_SIZE, randomGenerator, [&](size_t, RHEAPrefixCache::Simulation& simulation, std::mt19937& genomeRandomGenerator)
+        {
+            return RHEAGenome(simulation, params_, genomeRandomGenerator);
+        });
     }
 
-    std::vector<RHEAGenome> RHEAAgent::shiftPopulation(TBSForwardModel& forwardModel, TBSGameState& gameState, std::mt19937& randomGenerator)
+    std::vector<RHEAGenome> RHEAAgent::shiftPopulation(std::mt19937& randomGenerator)
     {
-        std::vector<RHEAGenome> newPop;
-
         // we shift the first individual, which is the only one that is likely to be feasible
-        pop_[0].shift(forwardModel, gameState, params_);
-        newPop.emplace_back(pop_[0]);
+        RHEAPrefixCache::Simulation simulation(prefixCache_, params_);
+        pop_[0].shift(simulation, randomGenerator);
+        prefixCache_.insert(simulation);
 
         // from 1 to (1+params._MUTATE_BEST), mutate the best individual
-        for (size_t i = 1; i <= params_.MUTATE_BEST && i < params_.POP_SIZE; ++i)
+        // from 1+params.MUTATE_BEST to params_.POP_SIZE, generate at random
+        const size_t newIndividuals = params_.POP_SIZE > 0 ? params_.POP_SIZE - 1 : 0;
+        auto newPop = createGenomes(newIndividuals, randomGenerator, [&](size_t index, RHEAPrefixCache::Simulation& simulation, std::mt19937& genomeRandomGenerator)
         {
-            RHEAGenome mutGen(pop_[0]);
-            mutGen.mutate(forwardModel, gameState, params_, randomGenerator);
-            newPop.emplace_back(mutGen);
-        }
+            if (index < params_.MUTATE_BEST)
+            {
+                RHEAGenome mutGen(pop_[0]);
+                mutGen.mutate(simulation, params_, genomeRandomGenerator);
+                return mutGen;
+            }
+            return RHEAGenome(simulation, params_, genomeRandomGenerator);
+        });
 
-        // from 1+params.MUTATE_BEST to params_.POP_SIZE, generate at random
-        for (size_t i = 1 + params_.MUTATE_BEST; i < params_.POP_SIZE; ++i) {
-            newPop.emplace_back(RHEAGenome(forwardModel, gameState, params_));
-        }
+        newPop.insert(newPop.begin(), pop_[0]);
         return newPop;
     }
 
 
     bool sortByFitness(const RHEAGenome& i, const RHEAGenome& j) { return i.getValue() > j.getValue(); }
 
-    void RHEAAgent::rheaLoop(TBSForwardModel& forwardModel, TBSGameState& gameState, std::mt19937& randomGenerator)
+    void RHEAAgent::rheaLoop(TBSGameState& gameState, std::mt19937& randomGenerator)
     {
-        // keep improving the population until the fmCall limit has been reached
-        while (params_.REMAINING_FM_CALLS > 0 && !gameState.isGameOver)
+        // keep improving the population until the budget has been used up
+        while (!params_.isBudgetExhausted() && !gameState.isGameOver)
         {
-            pop_ = nextGeneration(forwardModel, gameState, randomGenerator);
+            pop_ = nextGeneration(randomGenerator);
         }
         sort(pop_.begin(), pop_.end(), sortByFitness);
     }
 
-    std::vector<RHEAGenome> RHEAAgent::nextGeneration(TBSForwardModel& forwardModel, TBSGameState& gameState, std::mt19937& randomGenerator)
+    std::vector<RHEAGenome> RHEAAgent::nextGeneration(std::mt19937& randomGenerator)
     {
         // placeholder for the next generation
         std::vector<RHEAGenome> newPop;
@@ -107,47 +117,94 @@ namespace SGA
         }
 
         // add further individuals until the generation is full
-        while (newPop.size() < params_.POP_SIZE) {
-            newPop.emplace_back(getNextGenerationIndividual(forwardModel, gameState, randomGenerator));
-        }
-
-        return newPop;
-    }
-
-    RHEAGenome RHEAAgent::getNextGenerationIndividual(TBSForwardModel& forwardModel, TBSGameState& gameState, std::mt19937& randomGenerator)
-    {
+        // the parents are selected in the order of the new individuals, before they are created in parallel
+        const size_t newIndividuals = params_.POP_SIZE - newPop.size();
+        std::vector<std::pair<const RHEAGenome*, const RHEAGenome*>> parents(newIndividuals);
         if (params_.POP_SIZE > 1)
         {
-            std::vector<RHEAGenome> parents = tournamentSelection();
-            return RHEAGenome::crossover(forwardModel, gameState, params_, randomGenerator, parents[0], parents[1]);
+            for (auto& individualParents : parents)
+                individualParents = tournamentSelection(randomGenerator);
         }
-        else {
+
+        auto children = createGenomes(newIndividuals, randomGenerator, [&](size_t index, RHEAPrefixCache::Simulation& simulation, std::mt19937& genomeRandomGenerator)
+        {
+            if (params_.POP_SIZE > 1)
+            {
+                return RHEAGenome::crossover(simulation, params_, genomeRandomGenerator, *parents[index].first, *parents[index].second);
+            }
+
             RHEAGenome gMut(pop_[0]);
-            gMut.mutate(forwardModel, gameState, params_, randomGenerator);
+            gMut.mutate(simulation, params_, genomeRandomGenerator);
             return (gMut.getValue() >= pop_[0].getValue()) ? gMut : pop_[0];
-        }
+        });
+
+        for (auto& child : children)
+            newPop.emplace_back(std::move(child));
+        return newPop;
     }
 
-    std::vector<RHEAGenome> RHEAAgent::tournamentSelection()
+    std::pair<const RHEAGenome*, const RHEAGenome*> RHEAAgent::tournamentSelection(std::mt19937& randomGenerator) const
 	{
-        std::vector<RHEAGenome> tournament;
-        // sample subset, sort by fitness, select best individual
-        // parent 1
-        std::sample(pop_.begin(), pop_.end(), std::back_inserter(tournament),
-            params_.TOURNAMENT_SIZE, std::mt19937{ std::random_device{}() });
+        std::vector<size_t> indices(pop_.size());
+        std::iota(indices.begin(), indices.end(), 0);
+
+        // sample subset, select best individual
+        // std::sample keeps the order of the population, so ties are always broken the same way
+        auto selectParent = [&]()
+        {
+            std::vector<size_t> tournament;
+            std::sample(indices.begin(), indices.end(), std::back_inserter(tournament), params_.TOURNAMENT_SIZE, randomGenerator);
+
+            const RHEAGenome* best = &pop_[tournament.front()];
+            for (size_t index : tournament)
+            {
+                if (sortByFitness(pop_[index], *best))
+                    best = &pop_[index];
+            }
+            return best;
+        };
+
+        const RHEAGenome* parent1 = selectParent();
+        const RHEAGenome* parent2 = selectParent();
+        return { parent1, parent2 };
+    }
+
+    std::vector<RHEAGenome> RHEAAgent::createGenomes(size_t count, std::mt19937& randomGenerator, const GenomeGenerator& createGenome)
+    {
+        std::vector<unsigned int> seeds(count);
+        for (auto& seed : seeds)
+            seed = randomGenerator();
 
-        sort(tournament.begin(), tournament.end(), sortByFitness);
-        RHEAGenome& parent1 = tournament[0];
+        std::vector<RHEAPrefixCache::Simulation> simulations;
+        simulations.reserve(count);
+        for (size_t i = 0; i < count; i++)
+            simulations.emplace_back(prefixCache_, params_);
 
+        std::vector<std::optional<RHEAGenome>> genomes(count);
+        auto create = [&](size_t index)
+        {
+            std::mt19937 genomeRandomGenerator(seeds[index]);
+            genomes[index].emplace(createGenome(index, simulations[index], genomeRandomGenerator));
+        };
 
-        // parent 2
-        tournament.clear();
-        std::sample(pop_.begin(), pop_.end(), std::back_inserter(tournament),
-            params_.TOURNAMENT_SIZE, std::mt19937{ std::random_device{}() });
+        if (threadPool_ != nullptr)
+        {
+            threadPool_->parallelFor(count, create);
+        }
+        else
+        {
+            for (size_t i = 0; i < count; i++)
+                create(i);
+        }
 
-        std::sort(tournament.begin(), tournament.end(), sortByFitness);
-        RHEAGenome& parent2 = tournament[0];
+        // the cache is only read while the genomes are created
+        for (auto& simulation : simulations)
+            prefixCache_.insert(simulation);
 
-        return std::vector<RHEAGenome>{parent1, parent2};
+        std::vector<RHEAGenome> result;
+        result.reserve(count);
+        for (auto& genome : genomes)
+            result.emplace_back(std::move(*genome));
+        return result;
     }
 }
@@ -2,67 +2,55 @@
 
 namespace SGA {
 
-    RHEAGenome::RHEAGenome(TBSForwardModel& forwardModel, TBSGameState gameState, RHEAParams& params)
+    RHEAGenome::RHEAGenome(RHEAPrefixCache::Simulation& simulation, RHEAParams& params, std::mt19937& randomGenerator)
     {
-        auto actionSpace = forwardModel.generateActions(gameState);
-        const int playerID = gameState.currentPlayer;
-
         size_t length = 0;
-        while (!gameState.isGameOver && actionSpace.size() > 0 && length < params.INDIVIDUAL_LENGTH) {
+        while (canContinue(simulation) && length < params.INDIVIDUAL_LENGTH) {
             // choose and apply random action
-            //todo forward random generator to getRandomAction
-            auto action = actionSpace.at(rand() % actionSpace.size());
-            applyActionToGameState(forwardModel, gameState, actionSpace, action, params);
+            auto action = randomAction(simulation.getActionSpace(), randomGenerator);
+            simulation.applyAction(action);
             actions.emplace_back(action);
             length++;
         }
 
         // rate newly created individual
-        value = params.HEURISTIC.evaluateGameState(forwardModel, gameState, playerID);
+        value = simulation.evaluate();
     }
 
     RHEAGenome::RHEAGenome(std::vector<Action>& actions, double value) :
         actions(std::move(actions)), value(value) {}
 
-    void RHEAGenome::applyActionToGameState(const TBSForwardModel& forwardModel, TBSGameState& gameState, std::vector<Action>& actionSpace, const Action& action, RHEAParams& params)
+    bool RHEAGenome::canContinue(const RHEAPrefixCache::Simulation& simulation)
     {
-        params.REMAINING_FM_CALLS--;
-        forwardModel.advanceGameState(gameState, action);
-        while (gameState.currentPlayer != params.PLAYER_ID && !gameState.isGameOver)
-        {
-            if (params.opponentModel) // use default opponentModel to choose actions until the turn has ended
-            {
-                params.REMAINING_FM_CALLS--;
-                auto opActionSpace = forwardModel.generateActions(gameState);
-                auto opAction = params.opponentModel->getAction(gameState, opActionSpace);
-                forwardModel.advanceGameState(gameState, opAction);
-            }
-            else // skip opponent turn
-            {
-                forwardModel.advanceGameState(gameState, Action::createEndAction(gameState.currentPlayer));
-            }
-        }
+        return !simulation.getGameState().isGameOver && !simulation.getActionSpace().empty();
+    }
 
-        actionSpace = forwardModel.generateActions(gameState);
+    const Action& RHEAGenome::randomAction(const std::vector<Action>& actionSpace, std::mt19937& randomGenerator)
+    {
+        std::uniform_int_distribution<size_t> distribution(0, actionSpace.size() - 1);
+        return actionSpace[distribution(randomGenerator)];
     }
 
-    void RHEAGenome::mutate(TBSForwardModel& forwardModel, TBSGameState gameState, RHEAParams& params, std::mt19937& randomGenerator)
+    bool RHEAGenome::isAvailable(const std::vector<Action>& actionSpace, const Action& action)
     {
-        auto actionSpace = forwardModel.generateActions(gameState);
-        const int playerID = gameState.currentPlayer;
+        return std::find(actionSpace.begin(), actionSpace.end(), action) != actionSpace.end();
+    }
 
+    void RHEAGenome::mutate(RHEAPrefixCache::Simulation& simulation, RHEAParams& params, std::mt19937& randomGenerator)
+    {
         // go through the actions and fill the actionVector of its child
         unsigned long long actIdx = 0;
-        while (!gameState.isGameOver && actionSpace.size() > 0 && actIdx < params.INDIVIDUAL_LENGTH)
+        while (canContinue(simulation) && actIdx < params.INDIVIDUAL_LENGTH)
         {
+            const auto& actionSpace = simulation.getActionSpace();
             std::uniform_real_distribution<double> doubleDistribution_ = std::uniform_real_distribution<double>(0, 1);
             const bool mutate = doubleDistribution_(randomGenerator) < params.MUTATION_RATE;
 
-            // replace with random portfolio in case of mutate or no portfolio available
-            if (mutate || (actIdx < actions.size()))
+            // replace with random portfolio in case of mutate
+            if (mutate)
             {
-                auto action = actionSpace.at(rand() % actionSpace.size());
-                applyActionToGameState(forwardModel, gameState, actionSpace, action, params);
+                auto action = randomAction(actionSpace, randomGenerator);
+                simulation.applyAction(action);
                 if (actIdx < actions.size())
                 {
                     actions[actIdx] = action;
@@ -74,34 +62,35 @@ namespace SGA {
             }
             else
             {
-                // use previous action or sample a new random one in case the individual is too short
+                // use previous action or sample a new random one in case the individual is too short or the action cannot be executed anymore
                 if (actIdx >= actions.size())
                 {
-                    actions.emplace_back(actionSpace.at(rand() % actionSpace.size()));
+                    actions.emplace_back(randomAction(actionSpace, randomGenerator));
                 }
-                applyActionToGameState(forwardModel, gameState, actionSpace, actions[actIdx], params);
+                else if (!isAvailable(actionSpace, actions[actIdx]))
+                {
+                    actions[actIdx] = randomAction(actionSpace, randomGenerator);
+                }
+                simulation.applyAction(actions[actIdx]);
             }
 
             actIdx++;
         }
 
         // rate mutated individual
-        this->value = params.HEURISTIC.evaluateGameState(forwardModel, gameState, playerID);
+        this->value = simulation.evaluate();
     }
 
-    RHEAGenome RHEAGenome::crossover(TBSForwardModel& forwardModel, TBSGameState gameState, RHEAParams& params, std::mt19937& randomGenerator, RHEAGenome& parent1, RHEAGenome& parent2)
+    RHEAGenome RHEAGenome::crossover(RHEAPrefixCache::Simulation& simulation, RHEAParams& params, std::mt19937& randomGenerator, const RHEAGenome& parent1, const RHEAGenome& parent2)
     {
-        // create a new individual and its own gameState copy
-        auto actionSpace = forwardModel.generateActions(gameState);
-        const int playerID = gameState.currentPlayer;
-
     	// initialize variables for the new genome to be created
         std::vector<Action> actions;
 
         // step-wise add actions by mutation or crossover
         size_t actIdx = 0;
-        while (!gameState.isGameOver && actionSpace.size() > 0 && actIdx < params.INDIVIDUAL_LENGTH)
+        while (canContinue(simulation) && actIdx < params.INDIVIDUAL_LENGTH)
         {
+            const auto& actionSpace = simulation.getActionSpace();
             // if mutate do a random mutation else apply uniform crossover
             std::uniform_real_distribution<double> doubleDistribution_ = std::uniform_real_distribution<double>(0, 1);
             const bool mutate = doubleDistribution_(randomGenerator) < params.MUTATION_RATE;
@@ -109,72 +98,75 @@ namespace SGA {
             // mutation = randomly select a new action for gameStateCopy
             if (mutate)
             {
-                auto action = actionSpace.at(rand() % actionSpace.size());
-                applyActionToGameState(forwardModel, gameState, actionSpace, action, params);
+                auto action = randomAction(actionSpace, randomGenerator);
+                simulation.applyAction(action);
                 actions.emplace_back(action);
             }
             else
             {
-                int chosenPortfolio;
                 const bool useParent1First = doubleDistribution_(randomGenerator) < 0.5;
-                RHEAGenome& from = useParent1First ? parent1 : parent2;
+                const RHEAGenome* from = useParent1First ? &parent1 : &parent2;
                 // check the first parent and choose portfolio if available
-                if (actIdx < from.actions.size())
+                if (actIdx < from->actions.size())
                 {
-                    actions.emplace_back(from.actions[actIdx]);
+                    actions.emplace_back(from->actions[actIdx]);
                 }
                 else
                 {
                     // check the second parent and choose portfolio if available
-                    from = useParent1First ? parent2 : parent1;
-                    if (actIdx < from.actions.size())
+                    from = useParent1First ? &parent2 : &parent1;
+                    if (actIdx < from->actions.size())
                     {
-                        actions.emplace_back(from.actions[actIdx]);
+                        actions.emplace_back(from->actions[actIdx]);
                     }
                     else
                     {
                         // use a random portfolio by default
-                        actions.emplace_back(actionSpace.at(rand() % actionSpace.size()));
+                        actions.emplace_back(randomAction(actionSpace, randomGenerator));
                     }
                 }
-                applyActionToGameState(forwardModel, gameState, actionSpace, actions[actIdx], params);
+
+                // the parent planned the action for a different state, e.g. its target could be dead here
+                if (!isAvailable(actionSpace, actions[actIdx]))
+                {
+                    actions[actIdx] = randomAction(actionSpace, randomGenerator);
+                }
+                simulation.applyAction(actions[actIdx]);
             }
 
             actIdx++;
         }
 
-        const double value = params.HEURISTIC.evaluateGameState(forwardModel, gameState, playerID);
+        const double value = simulation.evaluate();
         return RHEAGenome(actions, value);
     }
 
-    void RHEAGenome::shift(TBSForwardModel& forwardModel, TBSGameState gameState, RHEAParams& params)
+    void RHEAGenome::shift(RHEAPrefixCache::Simulation& simulation, std::mt19937& randomGenerator)
     {
-        const int playerID = gameState.currentPlayer;
-
         // reuse previous solution
         std::rotate(actions.begin(), actions.begin() + 1, actions.end());
 
         // check if actions are still applicable and if not sample a new one from portfolio
         // always re-sample the last action since it is the rotated action from the previous solution
-        auto actionSpace = forwardModel.generateActions(gameState);
         for (size_t i = 0; i < actions.size(); i++)
         {
+            const auto& actionSpace = simulation.getActionSpace();
             if (actionSpace.size() == 0)
                 break;
 
             // test if a planned action is still valid. if not, replace with a random one
             // and always replace the last action with a new random one
             // (since the vector has been rotated it does not have any meaning)
-            if (i == actions.size() - 1 || !forwardModel.isValid(gameState, actions[i]))
+            if (i == actions.size() - 1 || !isAvailable(actionSpace, actions[i]))
             {
-                actions[i] = actionSpace.at(rand() % actionSpace.size());
+                actions[i] = randomAction(actionSpace, randomGenerator);
             }
     	
-            applyActionToGameState(forwardModel, gameState, actionSpace, actions[i], params);
+            simulation.applyAction(actions[i]);
         }
 
         // re-evaluate the shifted individual
-        value = params.HEURISTIC.evaluateGameState(forwardModel, gameState, playerID);
+        value = simulation.evaluate();
     }
 
     void RHEAGenome::toString() const
@@ -16,9 +16,12 @@ namespace SGA {
 
 		std::cout << "\tCONTINUE_SEARCH = " << CONTINUE_SEARCH << std::endl;
 		std::cout << "\tMUTATE_BEST = " << MUTATE_BEST << std::endl;
+		std::cout << "\tTHREADS = " << THREADS << std::endl;
+		std::cout << "\tPREFIX_CACHE_SIZE = " << PREFIX_CACHE_SIZE << std::endl;
 
 		std::cout << "\tMAX_FM_CALLS = " << MAX_FM_CALLS << std::endl;
 		std::cout << "\tREMAINING_FM_CALLS = " << REMAINING_FM_CALLS << std::endl;
+		std::cout << "\tMAX_TIME_MS = " << MAX_TIME_MS << std::endl;
 		std::cout << "\tPLAYER_ID = " << PLAYER_ID << std::endl;
 
 		std::cout << "\tHEURISTIC = " << HEURISTIC.getName() << std::endl;
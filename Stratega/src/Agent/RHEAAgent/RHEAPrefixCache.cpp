@@ -0,0 +1,112 @@
+#include <Stratega/Agent/RHEAAgent/RHEAPrefixCache.h>
+#include <Stratega/Agent/ActionScripts/RandomActionScript.h>
+
+namespace SGA {
+
+    RHEAPrefixCache::Simulation::Simulation(const RHEAPrefixCache& cache, RHEAParams& params) :
+        cache(cache), params(params), node(cache.root.get())
+    {
+    }
+
+    void RHEAPrefixCache::Simulation::applyAction(const Action& action)
+    {
+        if (node != nullptr)
+        {
+            // follow the cached prefix as long as possible
+            if (auto* child = findChild(*node, action))
+            {
+                node = child;
+                depth++;
+                return;
+            }
+
+            // continue with a copy of the deepest cached state
+            gameState = node->gameState;
+            actionSpace = node->actionSpace;
+            branch = node;
+            node = nullptr;
+        }
+
+        // the genomes of a generation can be evaluated in parallel, so the shared budget is counted atomically
+        params.consumeFMCalls(1);
+        const Action appliedAction = action;
+        cache.forwardModel->advanceGameState(gameState, appliedAction);
+
+        // the opponent's answer only depends on the reached state and the depth, so that it is the same for every genome sharing the prefix
+        RandomActionScript::setSeed(cache.opponentSeed + static_cast<unsigned int>(depth));
+        while (gameState.currentPlayer != params.PLAYER_ID && !gameState.isGameOver)
+        {
+            if (params.opponentModel) // use default opponentModel to choose actions until the turn has ended
+            {
+                params.consumeFMCalls(1);
+                auto opActionSpace = cache.forwardModel->generateActions(gameState);
+                auto opAction = params.opponentModel->getAction(gameState, opActionSpace);
+                cache.forwardModel->advanceGameState(gameState, opAction);
+            }
+            else // skip opponent turn
+            {
+                cache.forwardModel->advanceGameState(gameState, Action::createEndAction(gameState.currentPlayer));
+            }
+        }
+
+        actionSpace = cache.forwardModel->generateActions(gameState);
+        depth++;
+
+        // keep the new state for the cache, unless it is already full
+        if (cache.stateCount + newNodes.size() < cache.maxStates)
+        {
+            newNodes.emplace_back(Node{ appliedAction, gameState, actionSpace, {} });
+        }
+    }
+
+    double RHEAPrefixCache::Simulation::evaluate()
+    {
+        if (node != nullptr)
+        {
+            // a completely cached genome still costs a forward model call, otherwise a converged population would never use up the budget
+            params.consumeFMCalls(1);
+            gameState = node->gameState;
+        }
+        return params.HEURISTIC.evaluateGameState(*cache.forwardModel, gameState, cache.root->gameState.currentPlayer);
+    }
+
+    void RHEAPrefixCache::reset(const TBSForwardModel& forwardModel, const TBSGameState& rootState, unsigned int opponentSeed, size_t maxStates)
+    {
+        this->forwardModel = &forwardModel;
+        this->opponentSeed = opponentSeed;
+        this->maxStates = maxStates;
+        stateCount = 0;
+        root = std::make_unique<Node>(Node{ Action(), rootState, {}, {} });
+        root->actionSpace = forwardModel.generateActions(root->gameState);
+    }
+
+    void RHEAPrefixCache::insert(Simulation& simulation)
+    {
+        Node* parent = simulation.branch;
+        for (auto& newNode : simulation.newNodes)
+        {
+            // another genome of the same generation might have added the prefix already
+            Node* child = findChild(*parent, newNode.action);
+            if (child == nullptr)
+            {
+                if (stateCount >= maxStates)
+                    break;
+
+                child = parent->children.emplace_back(std::make_unique<Node>(std::move(newNode))).get();
+                stateCount++;
+            }
+            parent = child;
+        }
+        simulation.newNodes.clear();
+    }
+
+    RHEAPrefixCache::Node* RHEAPrefixCache::findChild(const Node& node, const Action& action)
+    {
+        for (const auto& child : node.children)
+        {
+            if (child->action == action)
+                return child.get();
+        }
+        return nullptr;
+    }
+}
@@ -26,8 +26,26 @@ namespace SGA
 	void RandomAgent::runRTS(RTSGameCommunicator& gameCommunicator, RTSForwardModel forwardModel)
 	{
 		auto lastExecution = std::chrono::high_resolution_clock::now();
+		int lastExecutionTick = 0;
 		while (!gameCommunicator.isGameOver())
 		{
+			if (gameCommunicator.isLockstep())
+			{
+				// Act once per simulated second, independent of how fast the game is running.
+				// The state is only copied when the agent acts, the other ticks just end
+				const int currentTick = gameCommunicator.getCurrentTick();
+				if ((currentTick - lastExecutionTick) * forwardModel.deltaTime >= 1)
+				{
+					auto state = gameCommunicator.getGameState();
+					auto actions = forwardModel.generateActions(state, gameCommunicator.getPlayerID());
+					std::uniform_int_distribution<int> actionDist(0, actions.size() - 1);
+					gameCommunicator.executeAction(actions.at(actionDist(gameCommunicator.getRNGEngine())));
+					lastExecutionTick = currentTick;
+				}
+				gameCommunicator.executeAction(Action::createEndAction(gameCommunicator.getPlayerID()));
+				continue;
+			}
+			
 			auto now = std::chrono::high_resolution_clock::now();
 			std::chrono::duration<double> deltaTime = now - lastExecution;
 			if (deltaTime.count() >= 1)
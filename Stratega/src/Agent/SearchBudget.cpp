@@ -0,0 +1,40 @@
+#include <Stratega/Agent/SearchBudget.h>
+
+namespace SGA
+{
+	void SearchBudget::startBudget(Clock::time_point start)
+	{
+		REMAINING_FM_CALLS = MAX_FM_CALLS;
+		startTime = start;
+		checksUntilClock = 0;
+		isTimeOver = false;
+	}
+
+	bool SearchBudget::isBudgetExhausted()
+	{
+		if (MAX_FM_CALLS > 0 && REMAINING_FM_CALLS <= 0)
+			return true;
+		if (MAX_TIME_MS <= 0 || isTimeOver)
+			return isTimeOver;
+
+		// reading the clock can cost as much as a cheap forward model call, so it is only done every few checks
+		if (--checksUntilClock > 0)
+			return false;
+
+		checksUntilClock = TIME_CHECK_INTERVAL;
+		isTimeOver = getElapsedMilliseconds() >= MAX_TIME_MS;
+		return isTimeOver;
+	}
+
+	bool SearchBudget::isSharedBudgetExhausted()
+	{
+		if (MAX_FM_CALLS > 0 && std::atomic_ref<int>(REMAINING_FM_CALLS).load(std::memory_order_relaxed) <= 0)
+			return true;
+		return isTimeExhausted();
+	}
+
+	double SearchBudget::getElapsedMilliseconds() const
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - startTime).count();
+	}
+}
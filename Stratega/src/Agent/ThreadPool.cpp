@@ -0,0 +1,75 @@
+#include <Stratega/Agent/ThreadPool.h>
+
+namespace SGA
+{
+	ThreadPool::ThreadPool(int threadCount)
+	{
+		for (int i = 1; i < threadCount; i++)
+			workers.emplace_back(&ThreadPool::work, this);
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			isStopping = true;
+		}
+		workAvailable.notify_all();
+		for (auto& worker : workers)
+			worker.join();
+	}
+
+	void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& task)
+	{
+		if (workers.empty() || count <= 1)
+		{
+			for (size_t i = 0; i < count; i++)
+				task(i);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			this->task = &task;
+			taskCount = count;
+			nextTask = 0;
+			busyWorkers = workers.size();
+			loop++;
+		}
+		workAvailable.notify_all();
+
+		runTasks();
+
+		// the task is owned by the caller, so the workers have to be done with it before returning
+		std::unique_lock<std::mutex> lock(mutex);
+		workFinished.wait(lock, [&]() { return busyWorkers == 0; });
+		this->task = nullptr;
+	}
+
+	void ThreadPool::work()
+	{
+		unsigned int finishedLoop = 0;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				workAvailable.wait(lock, [&]() { return isStopping || loop != finishedLoop; });
+				if (isStopping)
+					return;
+				finishedLoop = loop;
+			}
+
+			runTasks();
+
+			std::lock_guard<std::mutex> guard(mutex);
+			if (--busyWorkers == 0)
+				workFinished.notify_one();
+		}
+	}
+
+	void ThreadPool::runTasks()
+	{
+		for (size_t i = nextTask.fetch_add(1); i < taskCount; i = nextTask.fetch_add(1))
+			(*task)(i);
+	}
+}
@@ -0,0 +1,256 @@
+#include <Stratega/Agent/TreeSearchAgents/AlphaBetaAgent.h>
+#include <Stratega/Representation/StateHash.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace SGA
+{
+	namespace
+	{
+		// Remaining depth of a state whose subtree was searched until the end of the game, its value is exact for any depth
+		const int COMPLETE_DEPTH = std::numeric_limits<int>::max();
+	}
+
+	void AlphaBetaAgent::runTBS(TBSGameCommunicator& gameCommunicator, TBSForwardModel forwardModel)
+	{
+		while (!gameCommunicator.isGameOver())
+		{
+			if (gameCommunicator.isMyTurn())
+			{
+				auto gameState = gameCommunicator.getGameState();
+				if (gameState.isGameOver)
+					break;
+
+				auto actionSpace = forwardModel.generateActions(gameState);
+				if (actionSpace.size() == 1)
+				{
+					gameCommunicator.executeAction(actionSpace.at(0));
+				}
+				else
+				{
+					gameCommunicator.executeAction(actionSpace.at(search(forwardModel, gameState)));
+				}
+			}
+		}
+	}
+
+	size_t AlphaBetaAgent::search(TBSForwardModel& forwardModel, TBSGameState& gameState)
+	{
+		parameters_.startBudget();
+		playerID_ = gameState.currentPlayer;
+		killerMoves_.clear();
+		history_.clear();
+		if (parameters_.TRANSPOSITION_TABLE_SIZE > 0)
+		{
+			if (transpositionTable_ == nullptr)
+				transpositionTable_ = std::make_unique<TranspositionTable<AlphaBetaTransposition>>(parameters_.TRANSPOSITION_TABLE_SIZE);
+			transpositionTable_->newGeneration();
+		}
+
+		size_t bestActionIndex = 0;
+		rootActionIndex_ = -1;
+		isAborted_ = false;
+		for (int depth = 1; parameters_.MAX_DEPTH <= 0 || depth <= parameters_.MAX_DEPTH; depth++)
+		{
+			isDepthLimited_ = false;
+			int iterationActionIndex;
+			alphaBeta(forwardModel, gameState, depth, -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), 0, iterationActionIndex);
+
+			// the best action of the previous iteration is searched first, so an action that beat it in an aborted iteration is better
+			if (iterationActionIndex >= 0)
+			{
+				bestActionIndex = iterationActionIndex;
+				rootActionIndex_ = iterationActionIndex;
+			}
+
+			// a search that was not cut off by the depth limit does not change by searching deeper
+			if (isAborted_ || !isDepthLimited_)
+				break;
+		}
+
+		return bestActionIndex;
+	}
+
+	double AlphaBetaAgent::alphaBeta(TBSForwardModel& forwardModel, TBSGameState& gameState, int depth, double alpha, double beta, size_t ply, int& bestActionIndex)
+	{
+		bestActionIndex = -1;
+		if (gameState.isGameOver)
+		{
+			return heuristic_.evaluateGameState(forwardModel, gameState, playerID_);
+		}
+		if (depth == 0)
+		{
+			isDepthLimited_ = true;
+			return heuristic_.evaluateGameState(forwardModel, gameState, playerID_);
+		}
+		if (parameters_.isBudgetExhausted())
+		{
+			isAborted_ = true;
+			return 0;
+		}
+
+		// the bound of the stored value depends on the window the state was searched with
+		const double alphaOriginal = alpha;
+		const double betaOriginal = beta;
+		std::uint64_t hash = 0;
+		int transpositionActionIndex = -1;
+		if (transpositionTable_ != nullptr)
+		{
+			hash = hashState(gameState);
+			const auto* transposition = transpositionTable_->find(hash);
+			if (transposition != nullptr)
+			{
+				transpositionActionIndex = transposition->bestActionIndex;
+
+				// the root is always searched, so that its best action is known
+				if (ply > 0 && transposition->remainingDepth >= depth)
+				{
+					if (transposition->remainingDepth != COMPLETE_DEPTH)
+						isDepthLimited_ = true;
+
+					if (transposition->bound == AlphaBetaTransposition::Bound::Exact)
+						return transposition->value;
+					if (transposition->bound == AlphaBetaTransposition::Bound::Lower)
+						alpha = std::max(alpha, transposition->value);
+					else
+						beta = std::min(beta, transposition->value);
+					if (alpha >= beta)
+						return transposition->value;
+				}
+			}
+		}
+
+		auto actionSpace = forwardModel.generateActions(gameState);
+		if (actionSpace.empty())
+		{
+			return heuristic_.evaluateGameState(forwardModel, gameState, playerID_);
+		}
+
+		// the agent maximizes its heuristic, every opponent minimizes it
+		const bool isMaximizing = gameState.currentPlayer == playerID_;
+		double bestValue = isMaximizing ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+
+		const bool wasDepthLimited = isDepthLimited_;
+		isDepthLimited_ = false;
+		for (size_t index : orderActions(actionSpace, transpositionActionIndex, ply))
+		{
+			auto gsCopy(gameState);
+			parameters_.REMAINING_FM_CALLS--;
+			forwardModel.advanceGameState(gsCopy, actionSpace[index]);
+
+			int childActionIndex;
+			const double value = alphaBeta(forwardModel, gsCopy, depth - 1, alpha, beta, ply + 1, childActionIndex);
+			if (isAborted_)
+				return bestValue;
+
+			if (isMaximizing ? value > bestValue : value < bestValue)
+			{
+				bestValue = value;
+				bestActionIndex = static_cast<int>(index);
+			}
+
+			if (isMaximizing)
+				alpha = std::max(alpha, bestValue);
+			else
+				beta = std::min(beta, bestValue);
+
+			if (alpha >= beta)
+			{
+				addCutoff(actionSpace[index], depth, ply);
+				break;
+			}
+		}
+
+		const bool isSubtreeDepthLimited = isDepthLimited_;
+		isDepthLimited_ = wasDepthLimited || isSubtreeDepthLimited;
+
+		if (transpositionTable_ != nullptr)
+		{
+			auto& transposition = transpositionTable_->insert(hash);
+			transposition.remainingDepth = isSubtreeDepthLimited ? depth : COMPLETE_DEPTH;
+			transposition.value = bestValue;
+			transposition.bestActionIndex = bestActionIndex;
+			if (bestValue <= alphaOriginal)
+				transposition.bound = AlphaBetaTransposition::Bound::Upper;
+			else if (bestValue >= betaOriginal)
+				transposition.bound = AlphaBetaTransposition::Bound::Lower;
+			else
+				transposition.bound = AlphaBetaTransposition::Bound::Exact;
+		}
+
+		return bestValue;
+	}
+
+	std::vector<size_t> AlphaBetaAgent::orderActions(const std::vector<Action>& actionSpace, int transpositionActionIndex, size_t ply) const
+	{
+		// in the root the best action of the previous iteration comes first, even without a transposition table
+		// then the action of the transposition table, the killer moves and the actions with the highest history score
+		const std::int64_t rootScore = std::numeric_limits<std::int64_t>::max();
+		const std::int64_t transpositionScore = rootScore - 1;
+		const std::int64_t killerScore = transpositionScore / 2;
+
+		std::vector<std::pair<std::int64_t, size_t>> scores;
+		scores.reserve(actionSpace.size());
+		for (size_t i = 0; i < actionSpace.size(); i++)
+		{
+			std::int64_t score = 0;
+			if (ply == 0 && static_cast<int>(i) == rootActionIndex_)
+			{
+				score = rootScore;
+			}
+			else if (static_cast<int>(i) == transpositionActionIndex)
+			{
+				score = transpositionScore;
+			}
+			else
+			{
+				if (ply < killerMoves_.size())
+				{
+					const auto& killers = killerMoves_[ply];
+					const auto killer = std::find(killers.begin(), killers.end(), actionSpace[i]);
+					if (killer != killers.end())
+						score = killerScore - (killer - killers.begin());
+				}
+
+				if (score == 0 && parameters_.HISTORY_HEURISTIC)
+				{
+					const auto entry = history_.find(hashAction(actionSpace[i]));
+					if (entry != history_.end())
+						score = entry->second;
+				}
+			}
+			scores.emplace_back(score, i);
+		}
+
+		// ties keep the order of the action space
+		std::stable_sort(scores.begin(), scores.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+		std::vector<size_t> order;
+		order.reserve(scores.size());
+		for (const auto& score : scores)
+			order.emplace_back(score.second);
+		return order;
+	}
+
+	void AlphaBetaAgent::addCutoff(const Action& action, int depth, size_t ply)
+	{
+		if (parameters_.KILLER_MOVES > 0)
+		{
+			if (killerMoves_.size() <= ply)
+				killerMoves_.resize(ply + 1);
+
+			auto& killers = killerMoves_[ply];
+			if (std::find(killers.begin(), killers.end(), action) == killers.end())
+			{
+				killers.insert(killers.begin(), action);
+				if (killers.size() > static_cast<size_t>(parameters_.KILLER_MOVES))
+					killers.pop_back();
+			}
+		}
+
+		// cutoffs close to the root save more work
+		if (parameters_.HISTORY_HEURISTIC)
+			history_[hashAction(action)] += static_cast<std::int64_t>(depth) * depth;
+	}
+}
@@ -1,10 +1,17 @@
 #include <Stratega/Agent/TreeSearchAgents/BFSAgent.h>
+#include <Stratega/Representation/StateHash.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
 
 namespace SGA
 {
 	void BFSAgent::runTBS(TBSGameCommunicator& gameCommunicator, TBSForwardModel forwardModel)
 	{
 		const auto processedForwardModel = parameters_.preprocessForwardModel(&forwardModel);
+		if (parameters_.REPLAY_STATES || parameters_.MAX_OPEN_NODES > 0)
+			transitionSeeds.seed(gameCommunicator.getRNGEngine()());
 
 		while (!gameCommunicator.isGameOver())
 		{
@@ -23,6 +30,7 @@ namespace SGA
 					
 					// forget about your last action index, because the opponent will move in between
 					previousActionIndex = -1;
+					nodeArena.clear();
 					rootNode = nullptr;
 				}
 				else // else we run a full search
@@ -34,7 +42,7 @@ namespace SGA
 					search(*processedForwardModel, openNodes);
 
 					// retrieve best action
-					const int bestActionIndex = getBestActionIdx(*processedForwardModel);
+					const int bestActionIndex = getBestActionIdx();
 					auto action = rootNode->actionSpace.at(bestActionIndex);
 					gameCommunicator.executeAction(action);
 					
@@ -56,12 +64,21 @@ namespace SGA
 	void BFSAgent::init(TBSForwardModel& forwardModel, TBSGameState& gameState)
 	{
 		parameters_.PLAYER_ID = gameState.currentPlayer;
+		if (parameters_.TRANSPOSITION_TABLE_SIZE > 0)
+		{
+			// the states of a continued tree are added again while collecting its open nodes
+			if (transpositionTable == nullptr)
+				transpositionTable = std::make_unique<TranspositionTable<BFSTransposition>>(parameters_.TRANSPOSITION_TABLE_SIZE);
+			transpositionTable->clear();
+		}
+
 		if (parameters_.CONTINUE_PREVIOUS_SEARCH && previousActionIndex != -1)
 		{
 			// in case of a deterministic game we know that the previously simulated action
 			// should result in the same game-state as we predicted
-			rootNode = std::move(rootNode->children.at(previousActionIndex));
-			rootNode->parentNode = nullptr;	// release parent
+			rootNode = &rootNode->children[previousActionIndex];
+			rootNode->restoreState(forwardModel, parameters_);	// the parent is needed to replay the state
+			nodeArena.setRoot(rootNode);	// release parent and the rest of the old tree
 			fillOpenNodeListWithLeaves();
 		}
 		else
@@ -69,10 +86,12 @@ namespace SGA
 			// in case of non-deterministic games we don't know the outcome of our action
 			// additionally, in case the opponent did something since our last search,
 			// we don't know the moves and need to restart our search
-			rootNode = std::make_unique<TreeNode>(forwardModel, gameState);
+			rootNode = nodeArena.createRoot(forwardModel, gameState);
+			rootNode->value = parameters_.OBJECTIVE->evaluateGameState(forwardModel, rootNode->gameState, parameters_.PLAYER_ID);
 			openNodes.clear();
-			openNodes.push_back(rootNode.get());
+			openNodes.push_back(rootNode);
 			knownLeaves.clear();
+			isTransposition(rootNode);
 		}
 	}
 
@@ -80,37 +99,52 @@ namespace SGA
 	/// Iterate through all the game tree in BFS manner.
 	/// Store all the nodes that have not been completely expanded into openNodes.
 	/// Store nodes that represent leaves and have been completely expanded into knownLeaves.
+	/// Every node is evaluated once it is created, so that nodes can release their states and the open nodes can be pruned.
 	/// </summary>
 	/// <param name="forwardModel">the same forward model as used during the search</param>
 	/// <param name="openNodes">list of known open nodes</param>
 	void BFSAgent::search(TBSForwardModel& forwardModel, std::list<TreeNode*>& openNodes)
 	{
-		parameters_.REMAINING_FM_CALLS = parameters_.MAX_FM_CALLS;
+		parameters_.startBudget();
 		
-		while (parameters_.REMAINING_FM_CALLS > 0)
+		while (!parameters_.isBudgetExhausted())
 		{
 			TreeNode* child = nullptr;
 			while (child == nullptr && !openNodes.empty())
 			{
 				TreeNode* currentNode = openNodes.front();
-				child = currentNode->expand(forwardModel, parameters_);
+				currentNode->restoreState(forwardModel, parameters_);
+				// pruned nodes release their states as well, they are replayed if a continued search reaches them again
+				const bool isReplayable = parameters_.REPLAY_STATES || parameters_.MAX_OPEN_NODES > 0;
+				child = currentNode->expand(forwardModel, parameters_, isReplayable ? &transitionSeeds : nullptr);
 				if (child == nullptr)
 				{
 					openNodes.pop_front();	// node cannot be further expanded
+					if (isReplayable && currentNode != rootNode)
+						currentNode->releaseState();
 					if (openNodes.empty())	// all nodes have been explored
 						break;
 				}
 				else
 				{
+					child->value = parameters_.OBJECTIVE->evaluateGameState(forwardModel, child->gameState, parameters_.PLAYER_ID);
+					
 					// sort child node into its respective group
+					bool isOpen = false;
 					if (child->gameState.isGameOver)
 					{
 						knownLeaves.push_back(currentNode);
 					}
-					else
+					else if (!isTransposition(child))
 					{
 						openNodes.push_back(child);
+						isOpen = true;
+						pruneOpenNodes();
 					}
+
+					// with a limit of open nodes only they keep their states, so that the memory of the states stays bounded
+					if (parameters_.REPLAY_STATES || (parameters_.MAX_OPEN_NODES > 0 && !isOpen))
+						child->releaseState();
 				}
 			}
 
@@ -119,6 +153,41 @@ namespace SGA
 		}
 	}
 
+	void BFSAgent::pruneOpenNodes()
+	{
+		if (parameters_.MAX_OPEN_NODES == 0 || openNodes.size() <= parameters_.MAX_OPEN_NODES)
+			return;
+
+		// prune an eighth more than necessary, so that the list is not sorted for every new node
+		const size_t keepCount = std::max<size_t>(1, parameters_.MAX_OPEN_NODES - parameters_.MAX_OPEN_NODES / 8);
+		std::vector<double> values;
+		values.reserve(openNodes.size());
+		for (const TreeNode* node : openNodes)
+			values.emplace_back(node->value);
+		std::nth_element(values.begin(), values.begin() + (keepCount - 1), values.end(), std::greater<>());
+		const double threshold = values[keepCount - 1];
+		size_t remainingTies = keepCount - std::count_if(values.begin(), values.end(), [&](double value) { return value > threshold; });
+
+		// the kept nodes stay in breadth-first order
+		for (auto it = openNodes.begin(); it != openNodes.end();)
+		{
+			TreeNode* node = *it;
+			if (node->value > threshold || (node->value == threshold && remainingTies > 0))
+			{
+				if (node->value == threshold)
+					remainingTies--;
+				++it;
+			}
+			else
+			{
+				// the node stays in the tree, so that the indices of its siblings remain valid, but its state is not needed anymore
+				if (node != rootNode)
+					node->releaseState();
+				it = openNodes.erase(it);
+			}
+		}
+	}
+
 	/// <summary>
 	/// In case the tree is reused, we fill the openNodes and knownLeaves list according to the selected subtree.
 	/// </summary>
@@ -128,7 +197,7 @@ namespace SGA
 		knownLeaves.clear();
 		
 		std::list<TreeNode*> candidateNodes = std::list<TreeNode*>();
-		candidateNodes.push_back(rootNode.get());
+		candidateNodes.push_back(rootNode);
 
 		while (!candidateNodes.empty())
 		{
@@ -143,7 +212,9 @@ namespace SGA
 				}
 				else
 				{
-					if (node->children.size() != node->actionSpace.size())
+					// expanded nodes are added to the table as well, so that their states are not searched again
+					const bool transposition = isTransposition(node);
+					if (node->children.size() != node->actionSpace.size() && !transposition)
 					{
 						openNodes.push_back(node);
 					}
@@ -151,31 +222,51 @@ namespace SGA
 
 				for (auto& i : node->children)
 				{
-					candidateNodes.push_back(i.get());
+					candidateNodes.push_back(&i);
 				}
 			}
 		}
 	}
 
+	bool BFSAgent::isTransposition(TreeNode* node)
+	{
+		if (transpositionTable == nullptr)
+			return false;
+
+		int depth = 0;
+		for (const TreeNode* parent = node->parentNode; parent != nullptr; parent = parent->parentNode)
+			depth++;
+
+		// nodes of a continued tree might have released their states already
+		if (node->hasState)
+			node->stateHash = hashState(node->gameState);
+		const auto hash = node->stateHash;
+		if (const auto* transposition = transpositionTable->find(hash))
+		{
+			if (transposition->depth <= depth)
+				return true;
+		}
+
+		transpositionTable->insert(hash).depth = depth;
+		return false;
+	}
+
 	/// <summary>
 	/// Get the index of the first child on the path to the best leaf node.
 	/// </summary>
-	/// <param name="forwardModel">the same model as it has been used for the search</param>
 	/// <returns>index of the best child node</returns>
-	int BFSAgent::getBestActionIdx(TBSForwardModel& forwardModel)
+	int BFSAgent::getBestActionIdx() const
 	{
 		// iterate over all openNodes since they represent the tree's leafs
-		StateHeuristic* heuristic = parameters_.OBJECTIVE.get();
 		double bestHeuristicValue = -std::numeric_limits<double>::max();
-		TreeNode* bestChild = rootNode.get();
+		TreeNode* bestChild = rootNode;
 
 		// all nodes in openNodes and knownLeaves represent the end of a search path and could be the best node
 		for (TreeNode* node : openNodes)
 		{
-			const double value = heuristic->evaluateGameState(forwardModel, node->gameState, parameters_.PLAYER_ID);
-			if (value > bestHeuristicValue)
+			if (node->value > bestHeuristicValue)
 			{
-				bestHeuristicValue = value;
+				bestHeuristicValue = node->value;
 				bestChild = node;
 			}
 		}
@@ -183,10 +274,9 @@ namespace SGA
 		// repeat the same search for all knownLeaves
 		for (TreeNode* node : knownLeaves)
 		{
-			const double value = heuristic->evaluateGameState(forwardModel, node->gameState, parameters_.PLAYER_ID);
-			if (value > bestHeuristicValue)
+			if (node->value > bestHeuristicValue)
 			{
-				bestHeuristicValue = value;
+				bestHeuristicValue = node->value;
 				bestChild = node;
 			}
 		}
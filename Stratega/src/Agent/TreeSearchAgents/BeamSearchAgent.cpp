@@ -1,11 +1,15 @@
 #include <Stratega/Agent/TreeSearchAgents/BeamSearchAgent.h>
 
+#include <algorithm>
+
 
 namespace SGA
 {
 	void BeamSearchAgent::runTBS(TBSGameCommunicator& gameCommunicator, TBSForwardModel forwardModel)
 	{
 		const auto processedForwardModel = parameters_.preprocessForwardModel(&forwardModel);
+		if (parameters_.THREADS > 1 && threadPool_ == nullptr)
+			threadPool_ = std::make_unique<ThreadPool>(parameters_.THREADS);
 
 		while (!gameCommunicator.isGameOver())
 		{
@@ -15,85 +19,149 @@ namespace SGA
 				if (gameState.isGameOver)
 					break;
 				
-				TreeNode rootNode = TreeNode(*processedForwardModel, gameState);
-
-				if (rootNode.actionSpace.size() == 1)
+				const auto rootActions = processedForwardModel->generateActions(gameState);
+				if (rootActions.size() == 1)
 				{
-					gameCommunicator.executeAction(rootNode.actionSpace.at(0));
+					gameCommunicator.executeAction(rootActions.at(0));
 				} else
 				{
-					auto bestAction = beamSearch(*processedForwardModel, rootNode);
+					auto bestAction = beamSearch(*processedForwardModel, gameState, rootActions, gameCommunicator.getRNGEngine());
 					gameCommunicator.executeAction(bestAction);
 				}
 			}
 		}
 	}
 
-	Action BeamSearchAgent::beamSearch(TBSForwardModel& forwardModel, TreeNode& root)
+	Action BeamSearchAgent::beamSearch(TBSForwardModel& forwardModel, TBSGameState& gameState, const std::vector<Action>& rootActions, std::mt19937& randomGenerator)
 	{
-		parameters_.PLAYER_ID = root.gameState.currentPlayer;
+		parameters_.PLAYER_ID = gameState.currentPlayer;
+		parameters_.startBudget();
 
-		std::vector<TreeNode*> bestSimulations = simulate(forwardModel, root);
+		std::vector<BeamNode> root;
+		root.emplace_back(BeamNode{ gameState, 0, 0 });
+		std::vector<BeamNode> bestSimulations = expandLayer(forwardModel, root, true, randomGenerator());
 
-		for (size_t i = 1; i < parameters_.PLAYER_BEAM_DEPTH; i++)
+		for (size_t i = 1; i < parameters_.PLAYER_BEAM_DEPTH && !parameters_.isBudgetExhausted(); i++)
 		{
-			std::vector<TreeNode*> newBestSimulations = std::vector<TreeNode*>();
-			
-			for (TreeNode* child : bestSimulations)
-			{
-				std::vector<TreeNode*> childSims = simulate(forwardModel, *child);
-				for (TreeNode* childSim : childSims)
-				{
-					newBestSimulations.push_back(childSim);
-				}
-			}
-			
-			sort(newBestSimulations.begin(), newBestSimulations.end(), sortByValue);
-			if (newBestSimulations.size() > parameters_.PLAYER_BEAM_WIDTH)
-				newBestSimulations.erase(newBestSimulations.begin() + parameters_.PLAYER_BEAM_WIDTH, newBestSimulations.end());
-			bestSimulations = newBestSimulations;
+			bestSimulations = expandLayer(forwardModel, bestSimulations, false, randomGenerator());
 		}
 
-		sort(bestSimulations.begin(), bestSimulations.end(), sortByValue);
-		TreeNode* bestChild = bestSimulations.front();
-		while (bestChild->parentNode != nullptr)
+		if (bestSimulations.empty())
+			return rootActions.at(0);
+		return rootActions.at(bestSimulations.front().rootActionIndex);
+	}
+
+	std::vector<BeamSearchAgent::BeamNode> BeamSearchAgent::expandLayer(TBSForwardModel& forwardModel, std::vector<BeamNode>& beam, bool isRootLayer, unsigned int layerSeed)
+	{
+		// the cap on the states keeps the beam below half of it and splits the rest among the children of the beam nodes
+		size_t width = parameters_.PLAYER_BEAM_WIDTH;
+		size_t keepCount = parameters_.PLAYER_BEAM_WIDTH;
+		if (parameters_.PLAYER_BEAM_MAX_STATES > 0)
 		{
-			TreeNode* parent = bestChild->parentNode;
-			if (parent->parentNode == nullptr)
-			{
-				return parent->actionSpace.at(bestChild->childIndex);
-			}
-			bestChild = parent;
+			width = std::clamp<size_t>(parameters_.PLAYER_BEAM_MAX_STATES / 2, 1, width);
+			keepCount = std::clamp<size_t>((parameters_.PLAYER_BEAM_MAX_STATES - beam.size()) / beam.size(), 1, keepCount);
+		}
+
+		std::vector<std::vector<BeamNode>> children(beam.size());
+		auto expandNode = [&](size_t i)
+		{
+			// once the budget is used up, the beam continues with the nodes of the layer that were already simulated
+			if (i > 0 && parameters_.isSharedBudgetExhausted())
+				return;
+
+			RandomActionScript::setSeed(layerSeed + static_cast<unsigned int>(i));
+			children[i] = simulate(forwardModel, beam[i], isRootLayer, keepCount);
+		};
+
+		if (threadPool_ != nullptr)
+		{
+			threadPool_->parallelFor(beam.size(), expandNode);
+		}
+		else
+		{
+			for (size_t i = 0; i < beam.size(); i++)
+				expandNode(i);
 		}
 
-		return root.actionSpace.at(0);
+		// the states of the previous layer are not needed anymore
+		beam.clear();
+
+		std::vector<BeamNode> newBestSimulations;
+		for (auto& nodeChildren : children)
+		{
+			for (auto& child : nodeChildren)
+				newBestSimulations.emplace_back(std::move(child));
+			nodeChildren.clear();
+		}
+
+		// ties keep the order of the beam, no matter which thread finished first
+		std::stable_sort(newBestSimulations.begin(), newBestSimulations.end(), sortByValue);
+		if (newBestSimulations.size() > width)
+			newBestSimulations.erase(newBestSimulations.begin() + width, newBestSimulations.end());
+		return newBestSimulations;
 	}
 
-	bool BeamSearchAgent::sortByValue(const TreeNode* i, const TreeNode* j) { return i->value > j->value; }
+	bool BeamSearchAgent::sortByValue(const BeamNode& i, const BeamNode& j) { return i.value > j.value; }
 
-	std::vector<TreeNode*> BeamSearchAgent::simulate(TBSForwardModel& forwardModel, TreeNode& node)
+	std::vector<BeamSearchAgent::BeamNode> BeamSearchAgent::simulate(TBSForwardModel& forwardModel, BeamNode& node, bool isRoot, size_t keepCount)
 	{
-		std::vector<TreeNode*> bestSimulations = std::vector<TreeNode*>();
-		
-		// fully expand the whole node
-		while (node.expand(forwardModel, parameters_) != nullptr) {};
-		
-		// rate each child according to scoring function
-		for (auto& i : node.children)
+		std::vector<BeamNode> bestSimulations;
+
+		// a finished game stays in the beam as it is
+		auto actionSpace = forwardModel.generateActions(node.gameState);
+		if (node.gameState.isGameOver || actionSpace.empty())
 		{
-			auto* child = i.get();
-			child->value = parameters_.OBJECTIVE->evaluateGameState(forwardModel, child->gameState, parameters_.PLAYER_ID);
-			bestSimulations.push_back(child);
+			bestSimulations.emplace_back(std::move(node));
+			return bestSimulations;
 		}
 
-		// determine the best children
-		sort(bestSimulations.begin(), bestSimulations.end(), sortByValue);
+		// the children are simulated and rated in chunks, so that the kept children and a chunk are alive at once
+		std::vector<BeamNode> children;
+		std::vector<TBSGameState*> childStates;
+		std::vector<double> values;
+		const size_t chunkSize = std::max<size_t>(1, keepCount);
+		for (size_t begin = 0; begin < actionSpace.size(); begin += chunkSize)
+		{
+			const size_t end = std::min(actionSpace.size(), begin + chunkSize);
+			children.clear();
+			for (size_t i = begin; i < end; i++)
+			{
+				auto& child = children.emplace_back(BeamNode{ node.gameState, 0, isRoot ? i : node.rootActionIndex });
+
+				// roll the state using the action and let the opponent play until it is our turn again
+				parameters_.consumeFMCalls(1);
+				forwardModel.advanceGameState(child.gameState, actionSpace[i]);
+				while (child.gameState.currentPlayer != parameters_.PLAYER_ID && !child.gameState.isGameOver)
+				{
+					auto opponentActions = forwardModel.generateActions(child.gameState);
+					auto opAction = parameters_.OPPONENT_MODEL->getAction(child.gameState, opponentActions);
+					forwardModel.advanceGameState(child.gameState, opAction);
+					parameters_.consumeFMCalls(1);
+				}
+			}
+
+			// rate the children of the chunk according to scoring function at once
+			childStates.clear();
+			for (auto& child : children)
+				childStates.emplace_back(&child.gameState);
+			values.resize(children.size());
+			parameters_.OBJECTIVE->evaluateBatch(forwardModel, childStates, parameters_.PLAYER_ID, values);
+
+			// only keep the best children
+			for (size_t i = 0; i < children.size(); i++)
+			{
+				children[i].value = values[i];
+				const auto position = std::upper_bound(bestSimulations.begin(), bestSimulations.end(), children[i], sortByValue);
+				if (bestSimulations.size() < keepCount || position != bestSimulations.end())
+				{
+					bestSimulations.insert(position, std::move(children[i]));
+					if (bestSimulations.size() > keepCount)
+						bestSimulations.pop_back();
+				}
+			}
+		}
+		children.clear();
 
-		// delete all other children.
-		// !!!Note: the index of the child is no longer associated with the index of an action in the node's action space!!!
-		if (bestSimulations.size() > parameters_.PLAYER_BEAM_WIDTH)
-			bestSimulations.erase(bestSimulations.begin() + parameters_.PLAYER_BEAM_WIDTH, bestSimulations.end());
-			
 		return bestSimulations;
 	}
 }
@@ -1,15 +1,27 @@
 #include <Stratega/Agent/TreeSearchAgents/DFSAgent.h>
+#include <Stratega/Representation/StateHash.h>
+
+#include <algorithm>
 
 
 namespace SGA
 {
 	void DFSAgent::runTBS(TBSGameCommunicator& gameCommunicator, TBSForwardModel forwardModel)
 	{
+		if (parameters_.THREADS > 1 && threadPool_ == nullptr)
+			threadPool_ = std::make_unique<ThreadPool>(parameters_.THREADS);
+
 		while (!gameCommunicator.isGameOver())
 		{
 			if (gameCommunicator.isMyTurn())
 			{
-				remainingForwardModelCalls = forwardModelCalls;
+				parameters_.startBudget();
+				if (parameters_.TRANSPOSITION_TABLE_SIZE > 0)
+				{
+					if (transpositionTable == nullptr)
+						transpositionTable = std::make_unique<TranspositionTable<DFSTransposition>>(parameters_.TRANSPOSITION_TABLE_SIZE);
+					transpositionTable->newGeneration();
+				}
 
 				auto gameState = gameCommunicator.getGameState();
 				if (gameState.isGameOver)
@@ -22,25 +34,45 @@ namespace SGA
 				else
 				{
 
-					double bestHeuristicValue = -std::numeric_limits<double>::max();
-					int bestActionIndex = 0;
 					const int playerID = gameState.currentPlayer;
+					const unsigned int opponentSeed = gameCommunicator.getRNGEngine()();
 
-					for (size_t i = 0; i < actionSpace.size(); i++)
+					std::vector<double> values(actionSpace.size(), -std::numeric_limits<double>::max());
+					auto searchRootAction = [&](size_t i)
 					{
+						// the first action is always searched, so that the best action is known
+						if (i > 0 && parameters_.isSharedBudgetExhausted())
+							return;
+
+						// the opponent's actions only depend on the root action, not on the thread searching it
+						RandomActionScript::setSeed(opponentSeed + static_cast<unsigned int>(i));
 						auto gsCopy(gameState);
 						forwardModel.advanceGameState(gsCopy, actionSpace.at(i));
-						const double value = evaluateRollout(forwardModel, gameState, 1, playerID);
-						if (value > bestHeuristicValue)
+						values[i] = evaluateRollout(forwardModel, gsCopy, 1, playerID);
+					};
+
+					if (threadPool_ != nullptr)
+					{
+						threadPool_->parallelFor(actionSpace.size(), searchRootAction);
+					}
+					else
+					{
+						for (size_t i = 0; i < actionSpace.size(); i++)
+							searchRootAction(i);
+					}
+
+					// ties go to the first action, no matter which thread finished first
+					double bestHeuristicValue = -std::numeric_limits<double>::max();
+					size_t bestActionIndex = 0;
+					for (size_t i = 0; i < values.size(); i++)
+					{
+						if (values[i] > bestHeuristicValue)
 						{
-							bestHeuristicValue = value;
+							bestHeuristicValue = values[i];
 							bestActionIndex = i;
 						}
-						
-						if (remainingForwardModelCalls <= 0)
-							break;
 					}
-					//std::cout << "DFSAgent Number of FM calls: " << forwardModelCalls << std::endl;
+					//std::cout << "DFSAgent Number of FM calls: " << parameters_.MAX_FM_CALLS - parameters_.REMAINING_FM_CALLS << std::endl;
 
 					gameCommunicator.executeAction(actionSpace.at(bestActionIndex));
 				}
@@ -51,34 +83,53 @@ namespace SGA
 	double DFSAgent::evaluateRollout(TBSForwardModel& forwardModel, TBSGameState& gameState, int depth, const int playerID)
 	{
 		double bestValue = -std::numeric_limits<double>::max();
-		if (depth == maxDepth || gameState.isGameOver)
+		if (depth == parameters_.MAX_DEPTH || gameState.isGameOver)
 		{
 			return _stateHeuristic.evaluateGameState(forwardModel, gameState, playerID);
 		}
 		else
 		{
+			std::uint64_t hash = 0;
+			if (transpositionTable != nullptr)
+			{
+				hash = hashState(gameState);
+				std::lock_guard<std::mutex> guard(transpositionMutex_);
+				const auto* transposition = transpositionTable->find(hash);
+				if (transposition != nullptr && transposition->remainingDepth >= parameters_.MAX_DEPTH - depth)
+					return transposition->value;
+			}
+
 			auto actionSpace = forwardModel.generateActions(gameState);
 			for (const auto& action : actionSpace)
 			{
 				auto gsCopy(gameState);
-				applyActionToGameState(forwardModel, gameState, action);
+				applyActionToGameState(forwardModel, gsCopy, action);
 
 				double value = evaluateRollout(forwardModel, gsCopy, depth + 1, playerID);
 				if (value > bestValue)
 				{
 					bestValue = value;
 				}
-				if (remainingForwardModelCalls <= 0)
+				if (parameters_.isSharedBudgetExhausted())
 					return bestValue;
 			}
 
+			// only completely searched states are stored
+			if (transpositionTable != nullptr)
+			{
+				std::lock_guard<std::mutex> guard(transpositionMutex_);
+				auto& transposition = transpositionTable->insert(hash);
+				transposition.remainingDepth = parameters_.MAX_DEPTH - depth;
+				transposition.value = bestValue;
+			}
 			return bestValue;
 		}
 	}
 
 	void DFSAgent::applyActionToGameState(const TBSForwardModel& forwardModel, TBSGameState& gameState, const Action& action)
 	{
-		remainingForwardModelCalls--;
+		// the subtrees of the root actions can be searched in parallel, so the shared budget is counted atomically
+		parameters_.consumeFMCalls(1);
 		const int playerID = gameState.currentPlayer;
 		forwardModel.advanceGameState(gameState, action);
 		
@@ -94,7 +145,7 @@ namespace SGA
 			{
 				forwardModel.advanceGameState(gameState, Action::createEndAction(gameState.currentPlayer));
 			}
-			remainingForwardModelCalls--;
+			parameters_.consumeFMCalls(1);
 		}
 	}
 }
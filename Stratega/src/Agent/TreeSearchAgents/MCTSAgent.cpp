@@ -1,7 +1,48 @@
 #include <Stratega/Agent/TreeSearchAgents/MCTSAgent.h>
 
+#include <algorithm>
+#include <functional>
+#include <thread>
+
 namespace SGA
 {
+	namespace
+	{
+		using ThreadSearch = std::function<void(int threadIndex, MCTSParameters& threadParams, std::mt19937& threadRandomGenerator)>;
+
+		// Runs the search once per thread, each with its own share of the forward model calls and its own random generator
+		void runThreads(const MCTSParameters& params, std::mt19937& randomGenerator, const ThreadSearch& search)
+		{
+			const int threadCount = params.THREADS;
+
+			// the seeds are drawn in a fixed order, so a search with the same seed and number of threads gets the same generators
+			std::vector<unsigned int> seeds(threadCount);
+			for (auto& seed : seeds)
+				seed = randomGenerator();
+
+			auto searchThread = [&](int threadIndex)
+			{
+				std::mt19937 threadRandomGenerator(seeds[threadIndex]);
+				RandomActionScript::setSeed(threadRandomGenerator());
+
+				// a share of 0 would disable the limit, so every thread gets at least one call if the calls are limited
+				int fmCalls = params.MAX_FM_CALLS / threadCount + (threadIndex < params.MAX_FM_CALLS % threadCount ? 1 : 0);
+				if (params.MAX_FM_CALLS > 0)
+					fmCalls = std::max(1, fmCalls);
+				auto threadParams = params.createThreadParameters(fmCalls);
+				search(threadIndex, threadParams, threadRandomGenerator);
+			};
+
+			// the first search runs in the agent's thread
+			std::vector<std::thread> threads;
+			for (int i = 1; i < threadCount; i++)
+				threads.emplace_back(searchThread, i);
+			searchThread(0);
+			for (auto& thread : threads)
+				thread.join();
+		}
+	}
+
 	void MCTSAgent::runTBS(TBSGameCommunicator& gameCommunicator, TBSForwardModel forwardModel)
 	{
 		const auto processedForwardModel = parameters_.preprocessForwardModel(&forwardModel);
@@ -22,8 +63,17 @@ namespace SGA
                 if (actionSpace.size() == 1 || !parameters_.CONTINUE_PREVIOUS_SEARCH)
                 {
                     gameCommunicator.executeAction(actionSpace.at(0));
+                    nodeArena.clear();
+                    rootNode = nullptr;
+                    previousActionIndex = -1;
+                }
+                else if (parameters_.THREADS > 1 && !parameters_.SHARED_TREE)
+                {
+                    // the trees of a parallel search are not continued, their roots would search different actions
+                    nodeArena.clear();
                     rootNode = nullptr;
                     previousActionIndex = -1;
+                    gameCommunicator.executeAction(searchRootParallel(*processedForwardModel, gameState, gameCommunicator.getRNGEngine()));
                 }
                 else
                 {
@@ -31,19 +81,21 @@ namespace SGA
                     {
                         // in case of deterministic games we know which move has been done by us
                     	// reuse the tree from the previous iteration
-                        rootNode = std::move(rootNode->children.at(previousActionIndex));
-                        rootNode->parentNode = nullptr;	// release parent
+                        rootNode = &rootNode->children[previousActionIndex];
+                        rootNode->restoreState(*processedForwardModel, parameters_);
+                        nodeArena.setRoot(rootNode);	// release parent and the rest of the old tree
                         rootNode->setDepth(0);
+                        prepareTranspositionTables(1, false);
                     }
                     else
                     {
 						// start a new tree
-						rootNode = std::make_unique<MCTSNode>(*processedForwardModel, gameState);
+						rootNode = nodeArena.createRoot(*processedForwardModel, gameState);
+						prepareTranspositionTables(1, true);
                     }
                 	
                     //params.printDetails();
-                    parameters_.REMAINING_FM_CALLS = parameters_.MAX_FM_CALLS;
-                    rootNode->searchMCTS(*processedForwardModel, parameters_, gameCommunicator.getRNGEngine());
+                    searchTree(*processedForwardModel, *rootNode, gameCommunicator.getRNGEngine());
                     //rootNode->printTree();
 
                 	// get and store best action
@@ -58,4 +110,87 @@ namespace SGA
 			}
 		}
 	}
-}
\ No newline at end of file
+
+	Action MCTSAgent::searchAction(TBSForwardModel& forwardModel, const TBSGameState& gameState, std::mt19937& randomGenerator)
+	{
+		parameters_.PLAYER_ID = gameState.currentPlayer;
+		if (parameters_.THREADS > 1 && !parameters_.SHARED_TREE)
+			return searchRootParallel(forwardModel, gameState, randomGenerator);
+
+		NodeArena<MCTSNode> arena;
+		auto& root = *arena.createRoot(forwardModel, gameState);
+		prepareTranspositionTables(1, true);
+		searchTree(forwardModel, root, randomGenerator);
+		return root.actionSpace.at(root.mostVisitedAction(parameters_, randomGenerator));
+	}
+
+	Action MCTSAgent::searchRootParallel(TBSForwardModel& forwardModel, const TBSGameState& gameState, std::mt19937& randomGenerator)
+	{
+		// all trees search the same actions, a portfolio could generate different ones for every tree
+		RandomActionScript::setSeed(randomGenerator());
+		auto gameStateCopy(gameState);
+		const auto actionSpace = forwardModel.generateActions(gameStateCopy);
+
+		while (threadArenas.size() < static_cast<size_t>(parameters_.THREADS))
+			threadArenas.emplace_back(std::make_unique<NodeArena<MCTSNode>>());
+		prepareTranspositionTables(parameters_.THREADS, true);
+
+		std::vector<MCTSNode*> roots(parameters_.THREADS);
+		parameters_.startBudget();
+		runThreads(parameters_, randomGenerator, [&](int threadIndex, MCTSParameters& threadParams, std::mt19937& threadRandomGenerator)
+		{
+			roots[threadIndex] = threadArenas[threadIndex]->createRoot(gameState, actionSpace);
+			threadParams.transpositionTable = getTranspositionTable(threadIndex);
+			roots[threadIndex]->searchMCTS(forwardModel, threadParams, threadRandomGenerator);
+		});
+
+		// the roots reorder their action space when drawing the actions to expand, the index belongs to the actions of the first root
+		const int bestActionIndex = MCTSNode::mostVisitedAction(roots, parameters_, randomGenerator);
+		auto bestAction = roots.front()->actionSpace.at(bestActionIndex);
+		for (int i = 0; i < parameters_.THREADS; i++)
+			threadArenas[i]->clear();
+		return bestAction;
+	}
+
+	void MCTSAgent::searchTree(TBSForwardModel& forwardModel, MCTSNode& root, std::mt19937& randomGenerator)
+	{
+		if (parameters_.THREADS <= 1 || !parameters_.SHARED_TREE)
+		{
+			parameters_.startBudget();
+			parameters_.transpositionTable = getTranspositionTable(0);
+			root.searchMCTS(forwardModel, parameters_, randomGenerator);
+			return;
+		}
+
+		// the order in which the threads expand and update the tree varies, so unlike the other modes this search is not reproducible
+		parameters_.startBudget();
+		runThreads(parameters_, randomGenerator, [&](int, MCTSParameters& threadParams, std::mt19937& threadRandomGenerator)
+		{
+			root.searchMCTS(forwardModel, threadParams, threadRandomGenerator);
+		});
+	}
+
+	void MCTSAgent::prepareTranspositionTables(int count, bool newTree)
+	{
+		if (parameters_.TRANSPOSITION_TABLE_SIZE <= 0)
+			return;
+
+		while (transpositionTables.size() < static_cast<size_t>(count))
+			transpositionTables.emplace_back(std::make_unique<TranspositionTable<MCTSStatistics>>(parameters_.TRANSPOSITION_TABLE_SIZE));
+
+		for (int i = 0; i < count; i++)
+		{
+			// uct would avoid states that were visited by earlier trees, although the new tree does not count these visits when selecting the action
+			// a continued tree keeps the statistics of its nodes, so its table is kept as well, but the older entries are replaced first
+			if (newTree)
+				transpositionTables[i]->clear();
+			else
+				transpositionTables[i]->newGeneration();
+		}
+	}
+
+	TranspositionTable<MCTSStatistics>* MCTSAgent::getTranspositionTable(int index) const
+	{
+		return parameters_.TRANSPOSITION_TABLE_SIZE > 0 ? transpositionTables[index].get() : nullptr;
+	}
+}
@@ -1,14 +1,50 @@
 #include <Stratega/Agent/TreeSearchAgents/MCTSNode.h>
+#include <Stratega/Representation/StateHash.h>
+
+#include <algorithm>
+#include <cmath>
 
 namespace SGA
 {
-	MCTSNode::MCTSNode(TBSForwardModel& forwardModel, TBSGameState gameState) :
-		ITreeNode<SGA::MCTSNode>(forwardModel, std::move(gameState))
+	namespace
+	{
+		// Plain loads and stores are enough for a tree searched by one thread, the threads of a shared tree access the statistics atomically
+		template<typename T>
+		T load(T& value)
+		{
+			return std::atomic_ref<T>(value).load(std::memory_order_relaxed);
+		}
+
+		template<typename T>
+		void add(T& value, T delta)
+		{
+			std::atomic_ref<T>(value).fetch_add(delta, std::memory_order_relaxed);
+		}
+
+		void updateBounds(double* bounds, double result)
+		{
+			std::atomic_ref<double> lower(bounds[0]);
+			double current = lower.load(std::memory_order_relaxed);
+			while (result < current && !lower.compare_exchange_weak(current, result, std::memory_order_relaxed));
+
+			std::atomic_ref<double> upper(bounds[1]);
+			current = upper.load(std::memory_order_relaxed);
+			while (result > current && !upper.compare_exchange_weak(current, result, std::memory_order_relaxed));
+		}
+	}
+
+	MCTSNode::MCTSNode(NodeArena<MCTSNode>& arena, TBSForwardModel& forwardModel, TBSGameState gameState) :
+		ITreeNode<SGA::MCTSNode>(arena, forwardModel, std::move(gameState))
 	{
 	}
 
-	MCTSNode::MCTSNode(TBSForwardModel& forwardModel, TBSGameState gameState, MCTSNode* parent, const int childIndex) :
-		ITreeNode<SGA::MCTSNode>(forwardModel, std::move(gameState), parent, childIndex)
+	MCTSNode::MCTSNode(NodeArena<MCTSNode>& arena, TBSGameState gameState, std::vector<Action> actionSpace) :
+		ITreeNode<SGA::MCTSNode>(arena, std::move(gameState), std::move(actionSpace))
+	{
+	}
+
+	MCTSNode::MCTSNode(NodeArena<MCTSNode>& arena, TBSForwardModel& forwardModel, TBSGameState gameState, MCTSNode* parent, const int childIndex) :
+		ITreeNode<SGA::MCTSNode>(arena, forwardModel, std::move(gameState), parent, childIndex)
 	{
 	}
 
@@ -32,7 +68,7 @@ namespace SGA
 	{
 		nodeDepth = depth;
 		for (size_t i = 0; i < this->children.size(); i++) {
-			children.at(i)->setDepth(depth + 1);
+			children[i].setDepth(depth + 1);
 		}
 	}
 
@@ -58,25 +94,89 @@ namespace SGA
 	/// <param name="params">parameters of the search</param>
 	/// <param name="randomGenerator"></param>
 	void MCTSNode::searchMCTS(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator) {
+		if (params.EVALUATION_BATCH_SIZE > 1)
+		{
+			searchMCTSBatched(forwardModel, params, randomGenerator);
+			return;
+		}
+
 		int numIterations = 0;
 		bool stop = false;
 		int prevCallCount = params.REMAINING_FM_CALLS;
+		TBSGameState leafState;
+		if (params.transpositionTable != nullptr)
+			stateHash = hashState(gameState);
 
 		// stop in case the set number of fmCalls has been reached
 		while (!stop) {
-			MCTSNode* selected = treePolicy(forwardModel, params, randomGenerator);
+			MCTSNode* selected = treePolicy(forwardModel, params, randomGenerator, leafState);
 
-			const double delta = selected->rollOut(forwardModel, params, randomGenerator);
+			const double delta = selected->rollOut(forwardModel, params, randomGenerator, selected->hasState ? selected->gameState : leafState);
 			//cout << "delta: " << delta << "\n";
-			backUp(selected, delta);
+			if (params.SHARED_TREE)
+				backUpShared(selected, delta, params);
+			else
+				backUp(selected, delta);
+			if (params.transpositionTable != nullptr)
+				backUpTranspositions(selected, delta, *params.transpositionTable);
 			numIterations++;
 			//printTree();
 
-			stop = params.REMAINING_FM_CALLS <= 0 || numIterations == params.MAX_FM_CALLS;
+			stop = params.isBudgetExhausted() || numIterations == params.MAX_FM_CALLS;
 			prevCallCount = params.REMAINING_FM_CALLS;
 		}
 	}
 
+	void MCTSNode::searchMCTSBatched(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator)
+	{
+		const auto batchSize = static_cast<size_t>(params.EVALUATION_BATCH_SIZE);
+		std::vector<MCTSNode*> leaves;
+		std::vector<TBSGameState> leafStates(batchSize);
+		std::vector<TBSGameState*> evaluatedStates;
+		std::vector<double> values(batchSize);
+		if (params.transpositionTable != nullptr)
+			stateHash = hashState(gameState);
+
+		int numIterations = 0;
+		bool stop = false;
+		while (!stop)
+		{
+			// select the leaves and play their rollouts, the virtual loss keeps the selection from choosing the same path again
+			leaves.clear();
+			evaluatedStates.clear();
+			while (leaves.size() < batchSize && !stop)
+			{
+				auto& leafState = leafStates[leaves.size()];
+				MCTSNode* selected = treePolicy(forwardModel, params, randomGenerator, leafState);
+				TBSGameState& state = selected->hasState ? selected->gameState : leafState;
+				if (params.ROLLOUTS_ENABLED)
+				{
+					if (&state != &leafState)
+						leafState = state;
+					selected->playRollout(forwardModel, params, randomGenerator, leafState);
+					evaluatedStates.emplace_back(&leafState);
+				}
+				else
+				{
+					evaluatedStates.emplace_back(&state);
+				}
+				leaves.emplace_back(selected);
+
+				stop = params.isBudgetExhausted() || numIterations + static_cast<int>(leaves.size()) == params.MAX_FM_CALLS;
+			}
+
+			params.STATE_HEURISTIC->evaluateBatch(forwardModel, evaluatedStates, params.PLAYER_ID, std::span<double>(values.data(), leaves.size()));
+			for (size_t i = 0; i < leaves.size(); i++)
+			{
+				const double delta = normalize(values[i], 0, 1);
+				backUpShared(leaves[i], delta, params);
+				if (params.transpositionTable != nullptr)
+					backUpTranspositions(leaves[i], delta, *params.transpositionTable);
+			}
+			numIterations += static_cast<int>(leaves.size());
+		}
+	}
+
 	/// <summary>
 	/// Select the node to be expanded next.
 	/// Apply UCT until a node has been found that is not fully expanded yet
@@ -85,35 +185,162 @@ namespace SGA
 	/// <param name="params">parameters of the search</param>
 	/// <param name="randomGenerator"></param>
 	/// <returns></returns>
-	MCTSNode* MCTSNode::treePolicy(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator)
+	MCTSNode* MCTSNode::treePolicy(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator, TBSGameState& leafState)
 	{
 		MCTSNode* cur = this;
 
 		while (!cur->gameState.isGameOver)// && cur->nodeDepth < params.ROLLOUT_LENGTH)
 		{
-			if (!cur->isFullyExpanded()) {
-				return (cur->expand(forwardModel, params, randomGenerator));
+			if (cur->canExpand(params)) {
+				auto* child = cur->expand(forwardModel, params, randomGenerator, leafState);
+				// in a shared tree another thread could have expanded the last child in the meantime
+				if (child != nullptr)
+					return child;
 			}
 			else {
 				//printTree();
 				cur = cur->uct(params, randomGenerator);
+				if (params.usesVirtualLoss())
+					cur->addVirtualLoss(params);
 			}
 		}
+
+		if (!cur->hasState)
+			leafState = cur->getGameState(forwardModel, params);
 		return cur;
 	}
 
-	MCTSNode* MCTSNode::expand(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator)
+	MCTSNode* MCTSNode::expand(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator, TBSGameState& childState)
 	{
+		std::unique_lock<std::mutex> expansionGuard(expansionMutex, std::defer_lock);
+		if (params.SHARED_TREE)
+		{
+			expansionGuard.lock();
+			if (children.size() >= allowedChildren(params))
+				return nullptr;
+		}
+
 		// roll the state
 		//todo remove unnecessary copy of gameState
-		auto gsCopy(gameState);
-		childIndex = children.size();
-		applyActionToGameState(forwardModel, gsCopy, actionSpace.at(childIndex), params);
+		auto gsCopy = getGameState(forwardModel, params);
+		const int newChildIndex = static_cast<int>(children.size());
+		drawNextAction(forwardModel, params, randomGenerator, gsCopy);
+		unsigned int transitionSeed = 0;
+		if (params.REPLAY_STATES)
+		{
+			transitionSeed = randomGenerator();
+			RandomActionScript::setSeed(transitionSeed);
+		}
+		applyActionToGameState(forwardModel, gsCopy, actionSpace.at(newChildIndex), params);
 
 		// generate child node and add it to the tree
-		children.push_back(std::unique_ptr<MCTSNode>(new MCTSNode(forwardModel, std::move(gsCopy), this, childIndex)));
+		auto* child = addChild(forwardModel, std::move(gsCopy), this, newChildIndex);
+		if (params.transpositionTable != nullptr)
+			child->stateHash = hashState(child->gameState);
+		if (params.REPLAY_STATES)
+		{
+			child->transitionSeed = transitionSeed;
+			child->replayDistance = replayDistance + 1;
+			if (params.CHECKPOINT_INTERVAL > 0 && child->replayDistance >= params.CHECKPOINT_INTERVAL)
+				child->replayDistance = 0;
+			else
+				childState = child->releaseState();
+		}
+
+		// the virtual loss has to be added before other threads can select the child
+		if (params.usesVirtualLoss())
+			child->addVirtualLoss(params);
+		expandedChildren.store(children.size(), std::memory_order_release);
+
+		return child;
+	}
+
+	size_t MCTSNode::allowedChildren(const MCTSParameters& params)
+	{
+		if (params.WIDENING_K <= 0)
+			return actionSpace.size();
 
-		return children[childIndex].get();
+		// a node without visits can have one child as well, otherwise it would never be expanded
+		const auto widened = static_cast<size_t>(std::ceil(params.WIDENING_K * std::pow(load(nVisits), params.WIDENING_ALPHA)));
+		return std::min(actionSpace.size(), std::max<size_t>(1, widened));
+	}
+
+	void MCTSNode::drawNextAction(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator, TBSGameState& state)
+	{
+		// the expanded actions stay at the front of the action space, so the i-th child still belongs to the i-th action
+		const size_t next = children.size();
+		switch (params.WIDENING_PRIOR)
+		{
+			case WideningPrior::None:
+				if (params.WIDENING_K > 0)
+				{
+					std::uniform_int_distribution<size_t> distribution(next, actionSpace.size() - 1);
+					std::swap(actionSpace[next], actionSpace[distribution(randomGenerator)]);
+				}
+				break;
+			case WideningPrior::Script:
+			{
+				std::vector<Action> unexpanded(actionSpace.begin() + next, actionSpace.end());
+				const auto action = params.wideningScript->getAction(state, unexpanded);
+				const auto it = std::find(actionSpace.begin() + next, actionSpace.end(), action);
+				if (it != actionSpace.end())
+					std::iter_swap(actionSpace.begin() + next, it);
+				break;
+			}
+			case WideningPrior::Heuristic:
+				if (next == 0)
+					sortActionsByHeuristic(forwardModel, params, state);
+				break;
+		}
+	}
+
+	void MCTSNode::sortActionsByHeuristic(TBSForwardModel& forwardModel, MCTSParameters& params, const TBSGameState& state)
+	{
+		// only the action itself is applied, the opponent's turn would cost more forward model calls and make the rating noisy
+		// the children are rated in chunks of EVALUATION_BATCH_SIZE, so that the node does not hold the states of all its children at once
+		const size_t chunkSize = static_cast<size_t>(std::max(1, params.EVALUATION_BATCH_SIZE));
+		std::vector<TBSGameState> children;
+		std::vector<TBSGameState*> childStates;
+		std::vector<double> values;
+		std::vector<std::pair<double, size_t>> ratings(actionSpace.size());
+		for (size_t begin = 0; begin < actionSpace.size(); begin += chunkSize)
+		{
+			const size_t end = std::min(actionSpace.size(), begin + chunkSize);
+			children.assign(end - begin, state);
+			childStates.clear();
+			for (size_t i = begin; i < end; i++)
+			{
+				params.REMAINING_FM_CALLS--;
+				forwardModel.advanceGameState(children[i - begin], actionSpace[i]);
+				childStates.emplace_back(&children[i - begin]);
+			}
+
+			values.resize(children.size());
+			params.STATE_HEURISTIC->evaluateBatch(forwardModel, childStates, params.PLAYER_ID, values);
+			for (size_t i = begin; i < end; i++)
+				ratings[i] = { values[i - begin], i };
+		}
+		children.clear();
+
+		std::stable_sort(ratings.begin(), ratings.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+		// the actions are permuted in place, in a shared tree other threads read the size of the action space meanwhile
+		// position[i] is the current position of the action that was at index i
+		std::vector<size_t> position(actionSpace.size());
+		std::vector<size_t> original(actionSpace.size());
+		for (size_t i = 0; i < actionSpace.size(); i++)
+			position[i] = original[i] = i;
+		for (size_t target = 0; target < ratings.size(); target++)
+		{
+			const size_t source = position[ratings[target].second];
+			if (source == target)
+				continue;
+
+			std::swap(actionSpace[target], actionSpace[source]);
+			std::swap(original[target], original[source]);
+			position[original[source]] = source;
+			position[original[target]] = target;
+		}
 	}
 
 	double MCTSNode::normalize(const double aValue, const double aMin, const double aMax)
@@ -134,18 +361,38 @@ namespace SGA
 	{
 		const bool iAmMoving = (gameState.currentPlayer == params.PLAYER_ID);
 
-		std::vector<double> childValues(children.size(), 0);
+		// in a shared tree other threads can add children meanwhile, only the published ones are read
+		const size_t n = expandedChildren.load(std::memory_order_acquire);
+		std::vector<double> childValues(n, 0);
 
-		for (size_t i = 0; i < children.size(); ++i)
+		// with a transposition table the statistics of all nodes with the same state are used, if the state was not replaced yet
+		auto* transpositions = params.transpositionTable;
+		int visits = load(this->nVisits);
+		if (transpositions != nullptr)
 		{
-			MCTSNode* child = children[i].get();
+			if (const auto* statistics = transpositions->find(stateHash))
+				visits = statistics->visits;
+		}
 
-			const double hvVal = child->value;
-			double childValue = hvVal / (child->nVisits + params.EPSILON);
-			childValue = normalize(childValue, bounds[0], bounds[1]);
+		for (size_t i = 0; i < n; ++i)
+		{
+			MCTSNode* child = childBlock + i;
+
+			double hvVal = load(child->value);
+			int childVisits = load(child->nVisits);
+			if (transpositions != nullptr)
+			{
+				if (const auto* statistics = transpositions->find(child->stateHash))
+				{
+					hvVal = statistics->value;
+					childVisits = statistics->visits;
+				}
+			}
+			double childValue = hvVal / (childVisits + params.EPSILON);
+			childValue = normalize(childValue, load(bounds[0]), load(bounds[1]));
 
 			double uctValue = childValue +
-				params.K * sqrt(log(this->nVisits + 1) / (child->nVisits + params.EPSILON));
+				params.K * sqrt(log(visits + 1) / (childVisits + params.EPSILON));
 
 			uctValue = noise(uctValue, params.EPSILON, params.doubleDistribution_(randomGenerator));     //break ties randomly
 			childValues[i] = uctValue;
@@ -154,7 +401,7 @@ namespace SGA
 		int which = -1;
 		double bestValue = iAmMoving ? -std::numeric_limits<double>::max() : std::numeric_limits<double>::max();
 
-		for (int i = 0; i < children.size(); ++i) {
+		for (int i = 0; i < n; ++i) {
 			if ((iAmMoving && childValues[i] > bestValue) || (!iAmMoving && childValues[i] < bestValue)) {
 				which = i;
 				bestValue = childValues[i];
@@ -176,39 +423,43 @@ namespace SGA
 			std::cout << "\n\n";
 
 			//if(this.children.length == 0)
-			std::cout << "Warning! couldn't find the best UCT value " << which << " : " << children.size() << "\n";
+			std::cout << "Warning! couldn't find the best UCT value " << which << " : " << n << "\n";
 			std::cout << nodeDepth << ", AmIMoving? " << iAmMoving << "\n";
 
-			for (size_t i = 0; i < children.size(); ++i)
+			for (size_t i = 0; i < n; ++i)
 				std::cout << "\t" << childValues[i] << "\n";
 			std::cout << "; selected: " << which << "\n";
 			std::cout << "; isFullyExpanded: " << isFullyExpanded() << "\n";
-			std::uniform_int_distribution<> distrib(0, children.size() - 1);
+			std::uniform_int_distribution<> distrib(0, static_cast<int>(n) - 1);
 
 			which = distrib(randomGenerator);
 		}
 
-		return children[which].get();
+		return childBlock + which;
 	}
 
-	double MCTSNode::rollOut(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator)
+	double MCTSNode::rollOut(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator, TBSGameState& state)
 	{
 		if (params.ROLLOUTS_ENABLED) {
-			auto gsCopy(gameState);
-			int thisDepth = nodeDepth;
-
-			while (!(rolloutFinished(gsCopy, thisDepth, params) || gsCopy.isGameOver)) {
-				auto actions = forwardModel.generateActions(gsCopy);
-				if (actions.size() == 0)
-					break;
-				std::uniform_int_distribution<> randomDistribution(0, actions.size() - 1);
-				applyActionToGameState(forwardModel, gsCopy, actions.at(randomDistribution(randomGenerator)), params);
-				thisDepth++;
-			}
+			auto gsCopy(state);
+			playRollout(forwardModel, params, randomGenerator, gsCopy);
 			return normalize(params.STATE_HEURISTIC->evaluateGameState(forwardModel, gsCopy, params.PLAYER_ID), 0, 1);
 		}
 
-		return normalize(params.STATE_HEURISTIC->evaluateGameState(forwardModel, gameState, params.PLAYER_ID), 0, 1);
+		return normalize(params.STATE_HEURISTIC->evaluateGameState(forwardModel, state, params.PLAYER_ID), 0, 1);
+	}
+
+	void MCTSNode::playRollout(TBSForwardModel& forwardModel, MCTSParameters& params, std::mt19937& randomGenerator, TBSGameState& state) const
+	{
+		int thisDepth = nodeDepth;
+		while (!(rolloutFinished(state, thisDepth, params) || state.isGameOver)) {
+			auto actions = forwardModel.generateActions(state);
+			if (actions.size() == 0)
+				break;
+			std::uniform_int_distribution<> randomDistribution(0, actions.size() - 1);
+			applyActionToGameState(forwardModel, state, actions.at(randomDistribution(randomGenerator)), params);
+			thisDepth++;
+		}
 	}
 
 	bool MCTSNode::rolloutFinished(TBSGameState& rollerState, int depth, MCTSParameters& params)
@@ -220,7 +471,7 @@ namespace SGA
 		return rollerState.isGameOver;
 	}
 
-	void MCTSNode::applyActionToGameState(TBSForwardModel& forwardModel, TBSGameState& gameState, Action& action, MCTSParameters& params) const
+	void MCTSNode::applyActionToGameState(TBSForwardModel& forwardModel, TBSGameState& gameState, const Action& action, MCTSParameters& params) const
 	{
 		params.REMAINING_FM_CALLS--;
 		forwardModel.advanceGameState(gameState, action);
@@ -240,6 +491,36 @@ namespace SGA
 		}
 	}
 
+	TBSGameState MCTSNode::getGameState(TBSForwardModel& forwardModel, MCTSParameters& params) const
+	{
+		if (hasState)
+			return gameState;
+
+		// the root always has a state, so the recursion ends at most CHECKPOINT_INTERVAL nodes above
+		auto state = parentNode->getGameState(forwardModel, params);
+		RandomActionScript::setSeed(transitionSeed);
+		applyActionToGameState(forwardModel, state, parentNode->actionSpace.at(childIndex), params);
+		return state;
+	}
+
+	void MCTSNode::restoreState(TBSForwardModel& forwardModel, MCTSParameters& params)
+	{
+		if (hasState)
+			return;
+
+		gameState = getGameState(forwardModel, params);
+		hasState = true;
+		replayDistance = 0;
+	}
+
+	TBSGameState MCTSNode::releaseState()
+	{
+		// a moved-from state keeps its scalar fields, its containers are empty
+		TBSGameState state = std::move(gameState);
+		hasState = false;
+		return state;
+	}
+
 	void MCTSNode::backUp(MCTSNode* node, const double result)
 	{
 		MCTSNode* n = node;
@@ -257,7 +538,41 @@ namespace SGA
 		}
 	}
 
+	void MCTSNode::backUpShared(MCTSNode* node, const double result, const MCTSParameters& params)
+	{
+		MCTSNode* n = node;
+		while (n != nullptr)
+		{
+			// every node of the path except the root got a virtual loss during the selection
+			const int virtualLoss = n->parentNode != nullptr ? params.VIRTUAL_LOSS : 0;
+			add(n->nVisits, 1 - virtualLoss);
+			add(n->value, result);
+			updateBounds(n->bounds, result);
+			n = n->parentNode;
+		}
+	}
+
+	void MCTSNode::backUpTranspositions(MCTSNode* node, const double result, TranspositionTable<MCTSStatistics>& table)
+	{
+		for (MCTSNode* n = node; n != nullptr; n = n->parentNode)
+		{
+			auto& statistics = table.insert(n->stateHash);
+			statistics.visits++;
+			statistics.value += result;
+		}
+	}
+
+	void MCTSNode::addVirtualLoss(const MCTSParameters& params)
+	{
+		add(nVisits, params.VIRTUAL_LOSS);
+	}
+
 	int MCTSNode::mostVisitedAction(MCTSParameters& params, std::mt19937& randomGenerator)
+	{
+		return mostVisitedAction(std::vector<MCTSNode*>{ this }, params, randomGenerator);
+	}
+
+	int MCTSNode::mostVisitedAction(const std::vector<MCTSNode*>& roots, MCTSParameters& params, std::mt19937& randomGenerator)
 	{
 		int selected = -1;
 		double bestValue = -std::numeric_limits<double>::max();
@@ -267,34 +582,49 @@ namespace SGA
 		//cout << "Remaining budget: " << params.REMAINING_FM_CALLS << "\n";
 		//printTree();
 
-		//auto* childValues = new double[children.size()];
-		std::vector<double> childValues(children.size(), 0);
-		for (size_t i = 0; i < children.size(); ++i)
+		// the i-th child belongs to the i-th action of its root, but the roots can have drawn their actions in a different order
+		// so the statistics are summed up per action of the first root
+		const auto& actions = roots.front()->actionSpace;
+		size_t childCount = 0;
+		std::vector<int> childVisits(actions.size(), 0);
+		std::vector<double> childValues(actions.size(), 0);
+		for (const auto* root : roots)
 		{
-			MCTSNode* child = children[i].get();
+			for (size_t i = 0; i < root->children.size(); ++i)
+			{
+				size_t actionIndex = i;
+				if (i >= actions.size() || root->actionSpace[i] != actions[i])
+				{
+					// an action the first root does not know cannot be returned as its index, so its statistics are skipped
+					auto it = std::find(actions.begin(), actions.end(), root->actionSpace[i]);
+					if (it == actions.end())
+						continue;
+					actionIndex = it - actions.begin();
+				}
 
-			const double hvVal = child->value;
-			childValues[i] = hvVal;
+				childVisits[actionIndex] += root->children[i].nVisits;
+				childValues[actionIndex] += root->children[i].value;
+				childCount = std::max(childCount, actionIndex + 1);
+			}
 		}
+		childVisits.resize(childCount);
+		childValues.resize(childCount);
 
-		for (size_t i = 0; i < children.size(); i++) {
+		for (size_t i = 0; i < childCount; i++) {
 
-			if (children[i] != nullptr)
+			if (first == -1)
+				first = childVisits[i];
+			else if (first != childVisits[i])
 			{
-				if (first == -1)
-					first = children[i]->nVisits;
-				else if (first != children[i]->nVisits)
-				{
-					allEqual = false;
-				}
+				allEqual = false;
+			}
 
-				double childValue = children[i]->nVisits;
-				//double childValue = children[i]->totValue / children[i]->nVisits ;
-				childValue = noise(childValue, params.EPSILON, params.doubleDistribution_(randomGenerator));     //break ties randomly
-				if (childValue > bestValue) {
-					bestValue = childValue;
-					selected = i;
-				}
+			double childValue = childVisits[i];
+			//double childValue = children[i]->totValue / children[i]->nVisits ;
+			childValue = noise(childValue, params.EPSILON, params.doubleDistribution_(randomGenerator));     //break ties randomly
+			if (childValue > bestValue) {
+				bestValue = childValue;
+				selected = i;
 			}
 		}
 
@@ -305,7 +635,7 @@ namespace SGA
 		else if (allEqual)
 		{
 			//If all are equal, we opt to choose for the one with the best Q.
-			selected = bestAction(params, randomGenerator);
+			selected = bestAction(childVisits, childValues, params, randomGenerator);
 		}
 		//cout << "best action: " << actions.at(selected)->getName() << "\n";
 
@@ -313,19 +643,30 @@ namespace SGA
 	}
 
 	int MCTSNode::bestAction(MCTSParameters& params, std::mt19937& randomGenerator)
+	{
+		std::vector<int> childVisits(children.size(), 0);
+		std::vector<double> childValues(children.size(), 0);
+		for (size_t i = 0; i < children.size(); i++)
+		{
+			childVisits[i] = children[i].nVisits;
+			childValues[i] = children[i].value;
+		}
+
+		return bestAction(childVisits, childValues, params, randomGenerator);
+	}
+
+	int MCTSNode::bestAction(const std::vector<int>& childVisits, const std::vector<double>& childValues, MCTSParameters& params, std::mt19937& randomGenerator)
 	{
 		int selected = -1;
 		double bestValue = -std::numeric_limits<double>::max();
 
-		for (size_t i = 0; i < children.size(); i++) {
+		for (size_t i = 0; i < childVisits.size(); i++) {
 
-			if (children[i] != nullptr) {
-				double childValue = children[i]->value / (children[i]->nVisits + params.EPSILON);
-				childValue = noise(childValue, params.EPSILON, params.doubleDistribution_(randomGenerator));     //break ties randomly
-				if (childValue > bestValue) {
-					bestValue = childValue;
-					selected = i;
-				}
+			double childValue = childValues[i] / (childVisits[i] + params.EPSILON);
+			childValue = noise(childValue, params.EPSILON, params.doubleDistribution_(randomGenerator));     //break ties randomly
+			if (childValue > bestValue) {
+				bestValue = childValue;
+				selected = i;
 			}
 		}
 
@@ -4,6 +4,37 @@
 
 
 namespace SGA {
+	MCTSParameters MCTSParameters::createThreadParameters(int fmCalls) const
+	{
+		MCTSParameters params;
+		params.MAX_FM_CALLS = fmCalls;
+		params.MAX_TIME_MS = MAX_TIME_MS;
+		params.TIME_CHECK_INTERVAL = TIME_CHECK_INTERVAL;
+		params.startBudget(getStartTime());
+		params.PLAYER_ID = PLAYER_ID;
+		params.K = K;
+		params.ROLLOUT_LENGTH = ROLLOUT_LENGTH;
+		params.ROLLOUTS_ENABLED = ROLLOUTS_ENABLED;
+		params.FORCE_TURN_END = FORCE_TURN_END;
+		params.PRIORITIZE_ROOT = PRIORITIZE_ROOT;
+		params.EPSILON = EPSILON;
+		params.CONTINUE_PREVIOUS_SEARCH = CONTINUE_PREVIOUS_SEARCH;
+		params.THREADS = 1;
+		params.SHARED_TREE = SHARED_TREE;
+		params.VIRTUAL_LOSS = VIRTUAL_LOSS;
+		params.EVALUATION_BATCH_SIZE = EVALUATION_BATCH_SIZE;
+		params.REPLAY_STATES = REPLAY_STATES;
+		params.CHECKPOINT_INTERVAL = CHECKPOINT_INTERVAL;
+		params.TRANSPOSITION_TABLE_SIZE = TRANSPOSITION_TABLE_SIZE;
+		params.WIDENING_K = WIDENING_K;
+		params.WIDENING_ALPHA = WIDENING_ALPHA;
+		params.WIDENING_PRIOR = WIDENING_PRIOR;
+		params.wideningScript = wideningScript;
+		params.STATE_HEURISTIC = STATE_HEURISTIC;
+		params.opponentModel = opponentModel;
+		return params;
+	}
+
 	void MCTSParameters::printDetails() const
 	{
 		std::cout << "MCTSParameters" << "\n";
@@ -13,7 +44,18 @@ namespace SGA {
 		std::cout << "\tFORCE_TURN_END= " << FORCE_TURN_END << "\n";
 		std::cout << "\tPRIORITIZE_ROOT= " << PRIORITIZE_ROOT << "\n";
 		std::cout << "\tMAX_FM_CALLS= " << MAX_FM_CALLS << "\n";
+		std::cout << "\tMAX_TIME_MS= " << MAX_TIME_MS << "\n";
 		std::cout << "\tEPSILON = " << EPSILON << "\n";
+		std::cout << "\tTHREADS = " << THREADS << "\n";
+		std::cout << "\tSHARED_TREE = " << SHARED_TREE << "\n";
+		std::cout << "\tVIRTUAL_LOSS = " << VIRTUAL_LOSS << "\n";
+		std::cout << "\tEVALUATION_BATCH_SIZE = " << EVALUATION_BATCH_SIZE << "\n";
+		std::cout << "\tREPLAY_STATES = " << REPLAY_STATES << "\n";
+		std::cout << "\tCHECKPOINT_INTERVAL = " << CHECKPOINT_INTERVAL << "\n";
+		std::cout << "\tTRANSPOSITION_TABLE_SIZE = " << TRANSPOSITION_TABLE_SIZE << "\n";
+		std::cout << "\tWIDENING_K = " << WIDENING_K << "\n";
+		std::cout << "\tWIDENING_ALPHA = " << WIDENING_ALPHA << "\n";
+		std::cout << "\tWIDENING_PRIOR = " << static_cast<int>(WIDENING_PRIOR) << "\n";
 		std::cout << "\PLAYER_ID = " << PLAYER_ID << "\n";
 	}
 }
\ No newline at end of file
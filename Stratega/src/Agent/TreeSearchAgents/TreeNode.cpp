@@ -1,17 +1,18 @@
 #include <Stratega/Agent/TreeSearchAgents/TreeNode.h>
+#include <Stratega/Agent/ActionScripts/RandomActionScript.h>
 #include <iostream>
 #include <vector>
 
 namespace SGA
 {
 
-	TreeNode::TreeNode(TBSForwardModel& forwardModel, TBSGameState gameState) :
-		ITreeNode<SGA::TreeNode>(forwardModel, std::move(gameState))
+	TreeNode::TreeNode(NodeArena<TreeNode>& arena, TBSForwardModel& forwardModel, TBSGameState gameState) :
+		ITreeNode<SGA::TreeNode>(arena, forwardModel, std::move(gameState))
 	{
 	}
 
-	TreeNode::TreeNode(TBSForwardModel& forwardModel, TBSGameState gameState, TreeNode* parent, const int childIndex) :
-		ITreeNode<SGA::TreeNode>(forwardModel, std::move(gameState), parent, childIndex)
+	TreeNode::TreeNode(NodeArena<TreeNode>& arena, TBSForwardModel& forwardModel, TBSGameState gameState, TreeNode* parent, const int childIndex) :
+		ITreeNode<SGA::TreeNode>(arena, forwardModel, std::move(gameState), parent, childIndex)
 	{
 	}
 	
@@ -22,26 +23,75 @@ namespace SGA
 	/// <param name="forwardModel"></param>
 	/// <param name="agentParameters"></param>
 	/// <returns></returns>
-	TreeNode* TreeNode::expand(TBSForwardModel& forwardModel, AgentParameters& agentParameters)
+	TreeNode* TreeNode::expand(TBSForwardModel& forwardModel, AgentParameters& agentParameters, std::mt19937* seedGenerator)
 	{		
 		if (this->isFullyExpanded())
 			return nullptr;
 
 		// roll the state using a the next action that hasn't been expanded yet
 		auto gsCopy(gameState);
-		forwardModel.advanceGameState(gsCopy, actionSpace.at(static_cast<int>(children.size())));
+		unsigned int seed = 0;
+		if (seedGenerator != nullptr)
+		{
+			seed = (*seedGenerator)();
+			RandomActionScript::setSeed(seed);
+		}
+		applyActionToGameState(forwardModel, gsCopy, actionSpace.at(static_cast<int>(children.size())), agentParameters);
+		
+		auto* child = addChild(forwardModel, std::move(gsCopy), this, static_cast<int>(children.size()));
+		child->transitionSeed = seed;
+		return child;
+	}
+
+	void TreeNode::applyActionToGameState(TBSForwardModel& forwardModel, TBSGameState& gameState, const Action& action, AgentParameters& agentParameters)
+	{
+		forwardModel.advanceGameState(gameState, action);
 		agentParameters.REMAINING_FM_CALLS--;
 		
-		while (gsCopy.currentPlayer != agentParameters.PLAYER_ID && !gsCopy.isGameOver)
+		while (gameState.currentPlayer != agentParameters.PLAYER_ID && !gameState.isGameOver)
 		{
-			auto actionSpace = forwardModel.generateActions(gsCopy);
-			auto opAction = agentParameters.OPPONENT_MODEL->getAction(gsCopy, actionSpace);
-			forwardModel.advanceGameState(gsCopy, opAction);
+			auto actionSpace = forwardModel.generateActions(gameState);
+			auto opAction = agentParameters.OPPONENT_MODEL->getAction(gameState, actionSpace);
+			forwardModel.advanceGameState(gameState, opAction);
 			agentParameters.REMAINING_FM_CALLS--;
 		}
-		
-		children.emplace_back(std::unique_ptr<TreeNode>(new TreeNode(forwardModel, std::move(gsCopy), this, children.size())));
-		return children[children.size()-1].get();
+	}
+
+	TBSGameState TreeNode::getGameState(TBSForwardModel& forwardModel, AgentParameters& agentParameters) const
+	{
+		if (hasState)
+			return gameState;
+
+		// the root always has a state, so the recursion ends there at the latest
+		auto state = parentNode->getGameState(forwardModel, agentParameters);
+		RandomActionScript::setSeed(transitionSeed);
+		applyActionToGameState(forwardModel, state, parentNode->actionSpace.at(childIndex), agentParameters);
+		return state;
+	}
+
+	void TreeNode::restoreState(TBSForwardModel& forwardModel, AgentParameters& agentParameters)
+	{
+		if (hasState)
+			return;
+
+		gameState = getGameState(forwardModel, agentParameters);
+		hasState = true;
+	}
+
+	void TreeNode::releaseState()
+	{
+		if (!hasState)
+			return;
+
+		// the state is moved out to free its containers, the fields that stay valid are kept explicitly
+		const bool isGameOver = gameState.isGameOver;
+		const int currentPlayer = gameState.currentPlayer;
+		{
+			TBSGameState releasedState = std::move(gameState);
+		}
+		gameState.isGameOver = isGameOver;
+		gameState.currentPlayer = currentPlayer;
+		hasState = false;
 	}
 
 	void TreeNode::print() const
@@ -1,6 +1,8 @@
 #include <Stratega/Configuration/GameConfigParser.h>
 #include <Stratega/Agent/AgentFactory.h>
 #include <Stratega/Configuration/WinConditionType.h>
+#include <Stratega/Configuration/PathfindingType.h>
+#include <Stratega/Configuration/LocomotionType.h>
 #include <Stratega/Configuration/YamlHeaders.h>
 
 namespace SGA
@@ -316,7 +318,17 @@ namespace SGA
 		}
         else if(config.gameType == ForwardModelType::RTS)
         {
-            fm = std::make_unique<RTSForwardModel>();
+            auto rtsFM = std::make_unique<RTSForwardModel>();
+            rtsFM->pathfinding = fmNode["Pathfinding"].as<PathfindingType>(rtsFM->pathfinding);
+            rtsFM->locomotion = fmNode["Locomotion"].as<LocomotionType>(rtsFM->locomotion);
+            rtsFM->navMeshCacheDirectory = fmNode["NavMeshCacheDirectory"].as<std::string>(rtsFM->navMeshCacheDirectory.string());
+            if (auto crowdNode = fmNode["Crowd"]; crowdNode.IsDefined())
+            {
+                rtsFM->crowdConfig.maxAgents = crowdNode["MaxAgents"].as<int>(rtsFM->crowdConfig.maxAgents);
+                rtsFM->crowdConfig.avoidanceQuality = crowdNode["AvoidanceQuality"].as<int>(rtsFM->crowdConfig.avoidanceQuality);
+                rtsFM->crowdConfig.separationWeight = crowdNode["SeparationWeight"].as<float>(rtsFM->crowdConfig.separationWeight);
+            }
+            fm = std::move(rtsFM);
         }
 
 		// Parse WinCondition
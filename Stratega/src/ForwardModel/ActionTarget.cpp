@@ -1,6 +1,9 @@
 #include <Stratega/ForwardModel/ActionType.h>
 #include <Stratega/Representation/Player.h>
 #include <Stratega/Representation/GameState.h>
+
+#include <bit>
+
 namespace SGA
 {
 	ActionTarget ActionTarget::createPositionActionTarget(Vector2f position)
@@ -33,6 +36,38 @@ namespace SGA
 		return ActionTarget(Type::ContinuousActionReference, { .continuousActionID = continuousActionID });
 	}
 
+	bool ActionTarget::operator==(const ActionTarget& other) const
+	{
+		if (targetType != other.targetType)
+			return false;
+
+		switch (targetType)
+		{
+			case Position: return data.position == other.data.position;
+			case EntityReference: return data.entityID == other.data.entityID;
+			case PlayerReference: return data.playerID == other.data.playerID;
+			case EntityTypeReference: return data.entityTypeID == other.data.entityTypeID;
+			case TechnologyReference: return data.technologyID == other.data.technologyID;
+			case ContinuousActionReference: return data.continuousActionID == other.data.continuousActionID;
+		}
+		return false;
+	}
+
+	std::uint64_t ActionTarget::getHash() const
+	{
+		std::uint64_t value = 0;
+		switch (targetType)
+		{
+			case Position: value = (static_cast<std::uint64_t>(std::bit_cast<std::uint32_t>(data.position.x)) << 32) | std::bit_cast<std::uint32_t>(data.position.y); break;
+			case EntityReference: value = static_cast<std::uint32_t>(data.entityID); break;
+			case PlayerReference: value = static_cast<std::uint32_t>(data.playerID); break;
+			case EntityTypeReference: value = static_cast<std::uint32_t>(data.entityTypeID); break;
+			case TechnologyReference: value = static_cast<std::uint32_t>(data.technologyID); break;
+			case ContinuousActionReference: value = static_cast<std::uint32_t>(data.continuousActionID); break;
+		}
+		return value * 8 + targetType;
+	}
+
 	int ActionTarget::getPlayerID(const GameState& state) const
 	{
 		if (targetType == PlayerReference)
@@ -61,6 +61,11 @@ namespace  SGA
 		return false;
 	}
 	
+	double HasElapsedTime::getLowerBound(const GameState& state, const std::vector<ActionTarget>& targets) const
+	{
+		return lowerBound.getConstant(state, targets);
+	}
+
 	SamePlayer::SamePlayer(const std::vector<FunctionParameter>& parameters)
 	{
 		
@@ -54,27 +54,39 @@ namespace SGA
 		else if(const auto* rtsFM = dynamic_cast<const RTSForwardModel*>(&fm))
 		{
 			Entity& unit = targets[0].getEntity(state);
-			Vector2f targetPos = targets[1].getPosition(state);
+			const Vector2f finalTargetPos = targets[1].getPosition(state);
+			Vector2f targetPos = finalTargetPos;
 
-			//Get end position of current path
-			Vector2f oldTargetPos(0, 0);
-			oldTargetPos.x = unit.path.m_straightPath[(unit.path.m_nstraightPath - 1) * 3];
-			oldTargetPos.y = unit.path.m_straightPath[((unit.path.m_nstraightPath - 1) * 3) + 2];
-
-			//Check if path is empty or is a diferent path to the target pos
-			if (unit.path.m_nstraightPath == 0 || targetPos != oldTargetPos)
+			auto& rtsState = dynamic_cast<RTSGameState&>(state);
+			if (rtsState.crowd != nullptr && rtsState.crowd->isAgent(unit.id))
 			{
-				const auto& rtsState = dynamic_cast<RTSGameState&>(state);
-				Path path = rtsFM->findPath(rtsState, unit.position, targetPos);
-				unit.path = path;
-				unit.path.currentPathIndex++;
+				// The crowd moves the unit at the end of the tick
+				if (rtsState.crowd->moveTo(unit, finalTargetPos))
+				{
+					unit.executingAction.reset();
+					unit.path = Path();
+				}
+				return;
 			}
 
-			//Check if path has points to visit
-			if (unit.path.m_nstraightPath > 0)
+			bool pathPending = false;
+			if (rtsFM->pathfinding == PathfindingType::FlowField)
+			{
+				targetPos = rtsFM->followFlowField(rtsState, unit.position, finalTargetPos);
+				//The unit only arrives once it reached the target itself
+				pathPending = targetPos != finalTargetPos;
+			}
+			else
 			{
-				//Assign the current path index as target
-				targetPos = Vector2f(unit.path.m_straightPath[unit.path.currentPathIndex * 3], unit.path.m_straightPath[unit.path.currentPathIndex * 3 + 2]);
+				pathPending = rtsFM->updatePath(rtsState, unit, targetPos);
+
+				//Check if path has points to visit
+				//While a new path is pending the unit follows its old path and then walks straight towards the target
+				if (unit.path.currentPathIndex < unit.path.m_nstraightPath)
+				{
+					//Assign the current path index as target
+					targetPos = Vector2f(unit.path.m_straightPath[unit.path.currentPathIndex * 3], unit.path.m_straightPath[unit.path.currentPathIndex * 3 + 2]);
+				}
 			}
 
 			auto movementDir = targetPos - unit.position;
@@ -83,12 +95,15 @@ namespace SGA
 			if (movementDistance <= movementSpeed)
 			{
 				unit.path.currentPathIndex++;
-				if (unit.path.m_nstraightPath <= unit.path.currentPathIndex)
+				if (unit.path.m_nstraightPath <= unit.path.currentPathIndex && (!pathPending || targetPos == finalTargetPos))
 				{
 					if (movementDistance <= movementSpeed) {
+						if (unit.path.pathRequest != -1 && rtsState.pathRequests)
+							rtsState.pathRequests->cancel(unit.path.pathRequest);
+						
 						unit.position = targetPos;
 						//unit.executingAction.type = RTSActionType::None;
-						unit.executingAction = Action();
+						unit.executingAction.reset();
 						unit.path = Path();
 					}
 				}
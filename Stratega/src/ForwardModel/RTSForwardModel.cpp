@@ -1,5 +1,9 @@
 #include <Stratega/ForwardModel/RTSForwardModel.h>
+#include <Stratega/ForwardModel/Condition.h>
+#include <Stratega/Representation/NavigationCache.h>
 #include <cstring>
+#include <limits>
+#include <memory>
 
 namespace SGA
 {
@@ -20,6 +24,12 @@ namespace SGA
 		}
 		else // Advance game
 		{
+			// Spend the pathfinding budget before the units poll their requests
+			if (state.pathRequests)
+				state.pathRequests->update(state.navigation);
+			if (state.crowd)
+				state.crowd->sync(state);
+
 			// Update what the units are doing
 			for (auto& unit : state.entities)
 			{
@@ -32,9 +42,14 @@ namespace SGA
 
 			for (auto& unit : state.entities)
 			{
+				// Execute a copy, effects like Move can finish the action while it is executed
 				if(unit.executingAction.has_value())
-					executeAction(state, unit.executingAction.value());
+					executeAction(state, Action(unit.executingAction.value()));
 			}
+
+			// The crowd moves its agents all at once and keeps them apart, the collisions only move the other units
+			if (state.crowd)
+				state.crowd->update(state, static_cast<float>(deltaTime));
 			
 			resolveUnitCollisions(state);
 			resolveEnvironmentCollisions(state);
@@ -60,6 +75,117 @@ namespace SGA
 		}
 	}
 
+	int RTSForwardModel::ticksUntilNextEvent(const RTSGameState& state) const
+	{
+		int ticks = std::numeric_limits<int>::max();
+
+		// OnTick-trigger can change the state every tick
+		for (const auto& onTickEffect : onTickEffects)
+		{
+			for (const auto& entity : state.entities)
+			{
+				if (onTickEffect.validTargets.find(entity.typeID) != onTickEffect.validTargets.end())
+					return 0;
+			}
+		}
+
+		// Agents of the crowd keep moving until they stopped, even without an action
+		if (state.crowd != nullptr && state.crowd->hasMovingAgents())
+			return 0;
+
+		for (const auto& unit : state.entities)
+		{
+			// Moving units have to be simulated tick by tick because of the collisions
+			if (unit.executingAction.has_value() || unit.shouldRemove)
+				return 0;
+
+			// Skip until the cooldown expired, the entity can act again in the tick afterwards
+			if (unit.actionCooldown > 0)
+				ticks = std::min(ticks, static_cast<int>(std::ceil(unit.actionCooldown / deltaTime)));
+		}
+
+		// Continuous actions can be skipped until the tick in which they complete
+		auto continuousActionTicks = [&](const std::vector<Action>& continuousActions)
+		{
+			for (const auto& action : continuousActions)
+			{
+				const auto& actionType = state.actionTypes->at(action.actionTypeID);
+				if (!actionType.OnTick.empty() || actionType.triggerComplete.empty())
+					return 0;
+
+				int completeTicks = 0;
+				for (const auto& condition : actionType.triggerComplete)
+				{
+					// Only the elapsed time is predictable, every other condition has to be checked each tick
+					const auto* elapsedTime = dynamic_cast<const HasElapsedTime*>(condition.get());
+					if (elapsedTime == nullptr)
+						return 0;
+
+					auto lowerBound = std::ceil(elapsedTime->getLowerBound(state, action.targets));
+					completeTicks = std::max(completeTicks, static_cast<int>(lowerBound) - action.elapsedTicks);
+				}
+				
+				ticks = std::min(ticks, completeTicks);
+			}
+			return ticks;
+		};
+
+		for (const auto& unit : state.entities)
+		{
+			if (continuousActionTicks(unit.continuousAction) <= 0)
+				return 0;
+		}
+
+		for (const auto& player : state.players)
+		{
+			if (continuousActionTicks(player.continuousAction) <= 0)
+				return 0;
+		}
+
+		if (hasPendingCollisions(state))
+			return 0;
+		
+		return ticks;
+	}
+
+	int RTSForwardModel::fastForward(RTSGameState& state, int maxTicks) const
+	{
+		const int ticks = std::min(maxTicks, ticksUntilNextEvent(state));
+		int skippedTicks = 0;
+		bool cooldownExpired = false;
+		while (skippedTicks < ticks && !cooldownExpired)
+		{
+			// Same order and arithmetic as advanceGameState, so skipping ticks does not change the outcome
+			for (auto& unit : state.entities)
+			{
+				if (unit.actionCooldown <= 0)
+					continue;
+				
+				unit.actionCooldown = std::max(0., unit.actionCooldown - deltaTime);
+				cooldownExpired |= unit.actionCooldown <= 0;
+			}
+
+			state.currentTick++;
+			for (auto& unit : state.entities)
+			{
+				for (auto& action : unit.continuousAction)
+					action.elapsedTicks++;
+			}
+			for (auto& player : state.players)
+			{
+				for (auto& action : player.continuousAction)
+					action.elapsedTicks++;
+			}
+			
+			skippedTicks++;
+		}
+
+		if (skippedTicks > 0)
+			state.isGameOver = checkGameIsFinished(state);
+		
+		return skippedTicks;
+	}
+
 	std::vector<Action> RTSForwardModel::generateActions(RTSGameState& state) const
 	{
 		throw std::runtime_error("Can't generate actions without an playerID for RTS-Games");
@@ -237,6 +363,9 @@ namespace SGA
 	{
 		for (auto& unit : state.entities)
 		{
+			if (state.crowd != nullptr && state.crowd->isAgent(unit.id))
+				continue;
+
 			Vector2f pushDir;
 			for (auto& otherUnit : state.entities)
 			{
@@ -269,6 +398,10 @@ namespace SGA
 		// Collision
 		for (auto& unit : state.entities)
 		{
+			// Agents of the crowd are kept on the navmesh by the crowd
+			if (state.crowd != nullptr && state.crowd->isAgent(unit.id))
+				continue;
+
 			int startCheckPositionX = std::floor(unit.position.x - unit.collisionRadius - RECT_SIZE);
 			int endCheckPositionX = std::ceil(unit.position.x + unit.collisionRadius + RECT_SIZE);
 			int startCheckPositionY = std::floor(unit.position.y - unit.collisionRadius - RECT_SIZE);
@@ -304,348 +437,510 @@ namespace SGA
 		}
 	}
 
-	bool RTSForwardModel::buildNavMesh(RTSGameState& state, NavigationConfig config) const
+	bool RTSForwardModel::hasPendingCollisions(const RTSGameState& state) const
 	{
-		auto t1 = std::chrono::high_resolution_clock::now();
-
-		state.navigation = std::make_shared<Navigation>();
-
-		state.navigation->config = config;
+		static float RECT_SIZE = 1;
+		
+		for (const auto& unit : state.entities)
+		{
+			// The crowd resolves the collisions of its agents
+			if (state.crowd != nullptr && state.crowd->isAgent(unit.id))
+				continue;
 
-		//Get size from current board
-		auto& board = state.board;
-		float width = board.getWidth();
-		float height = board.getHeight();
-		float cellSize = 1;
+			// Overlapping units push each other apart
+			if (state.getEntityType(unit.typeID).canExecuteAction(2))
+			{
+				for (const auto& otherUnit : state.entities)
+				{
+					if (unit.id != otherUnit.id && (otherUnit.position - unit.position).magnitude() <= unit.collisionRadius + otherUnit.collisionRadius)
+						return true;
+				}
+			}
 
-		state.navigation->cleanup();
+			// Units overlapping un-walkable tiles are pushed out of them
+			int startCheckPositionX = std::floor(unit.position.x - unit.collisionRadius - RECT_SIZE);
+			int endCheckPositionX = std::ceil(unit.position.x + unit.collisionRadius + RECT_SIZE);
+			int startCheckPositionY = std::floor(unit.position.y - unit.collisionRadius - RECT_SIZE);
+			int endCheckPositionY = std::ceil(unit.position.y + unit.collisionRadius + RECT_SIZE);
+			for (int x = startCheckPositionX; x <= endCheckPositionX; x++)
+			{
+				for (int y = startCheckPositionY; y <= endCheckPositionY; y++)
+				{
+					if (state.board.isInBounds(x, y) && state.board.get(x, y).isWalkable)
+						continue;
 
-		float m_meshBMin[3]{ 0,0,0 };
-		float m_meshBMax[3]{ width,10,height };
-		const float* bmin = m_meshBMin;
-		const float* bmax = m_meshBMax;
+					auto fx = static_cast<float>(x);
+					auto fy = static_cast<float>(y);
+					auto nearestX = std::max(fx, std::min(unit.position.x, fx + RECT_SIZE));
+					auto nearestY = std::max(fy, std::min(unit.position.y, fy + RECT_SIZE));
+					if (unit.collisionRadius - (unit.position - Vector2f(nearestX, nearestY)).magnitude() > 0)
+						return true;
+				}
+			}
+		}
 
-		//
-		// Step 1. Initialize build config.
-		//
+		return false;
+	}
 
-		// Init build configuration from GUI
-		memset(&state.navigation->m_cfg, 0, sizeof(state.navigation->m_cfg));
-
-		state.navigation->m_cfg.cs = state.navigation->config.m_cellSize;
-		state.navigation->m_cfg.ch = state.navigation->config.m_cellHeight;
-		state.navigation->m_cfg.walkableSlopeAngle = state.navigation->config.m_agentMaxSlope;
-		state.navigation->m_cfg.walkableHeight = (int)ceilf(state.navigation->config.m_agentHeight / state.navigation->m_cfg.ch);
-		state.navigation->m_cfg.walkableClimb = (int)floorf(state.navigation->config.m_agentMaxClimb / state.navigation->m_cfg.ch);
-		state.navigation->m_cfg.walkableRadius = (int)ceilf(state.navigation->config.m_agentRadius / state.navigation->m_cfg.cs);
-		state.navigation->m_cfg.maxEdgeLen = (int)(state.navigation->config.m_edgeMaxLen / state.navigation->config.m_cellSize);
-		state.navigation->m_cfg.maxSimplificationError = state.navigation->config.m_edgeMaxError;
-		state.navigation->m_cfg.minRegionArea = (int)rcSqr(state.navigation->config.m_regionMinSize);		// Note: area = size*size
-		state.navigation->m_cfg.mergeRegionArea = (int)rcSqr(state.navigation->config.m_regionMergeSize);	// Note: area = size*size
-		state.navigation->m_cfg.maxVertsPerPoly = (int)state.navigation->config.m_vertsPerPoly;
-		state.navigation->m_cfg.detailSampleDist = state.navigation->config.m_detailSampleDist < 0.9f ? 0 : state.navigation->config.m_cellSize * state.navigation->config.m_detailSampleDist;
-		state.navigation->m_cfg.detailSampleMaxError = state.navigation->config.m_cellHeight * state.navigation->config.m_detailSampleMaxError;
+	namespace
+	{
+		// Upper bounds of the tile cache, a flat board only has one layer per tile
+		const int EXPECTED_LAYERS_PER_TILE = 4;
+		const int MAX_LAYERS = 32;
+		const int MAX_NAVMESH_OBSTACLES = 128;
+		// The tile cache gives up tracing contours longer than the area of a tile, which cuts off regions in very small tiles
+		const int MIN_TILE_SIZE = 12;
+
+		// Rasterizes the board into the layers of a tile of the tile cache
+		bool buildTileCacheLayers(const Grid2D<Tile>& board, Navigation& navigation, int tx, int ty, std::vector<std::pair<unsigned char*, int>>& layers)
+		{
+			const auto& cfg = navigation.m_cfg;
+			const float tcs = cfg.tileSize * cfg.cs;
+
+			// Tile bounds including the border, so that neighbouring tiles match
+			rcConfig tcfg;
+			memcpy(&tcfg, &cfg, sizeof(tcfg));
+			tcfg.bmin[0] = cfg.bmin[0] + tx * tcs - cfg.borderSize * cfg.cs;
+			tcfg.bmin[2] = cfg.bmin[2] + ty * tcs - cfg.borderSize * cfg.cs;
+			tcfg.bmax[0] = cfg.bmin[0] + (tx + 1) * tcs + cfg.borderSize * cfg.cs;
+			tcfg.bmax[2] = cfg.bmin[2] + (ty + 1) * tcs + cfg.borderSize * cfg.cs;
+
+			std::unique_ptr<rcHeightfield, decltype(&rcFreeHeightField)> solid(rcAllocHeightfield(), &rcFreeHeightField);
+			if (!solid || !rcCreateHeightfield(&navigation.m_ctx, *solid, tcfg.width, tcfg.height, tcfg.bmin, tcfg.bmax, tcfg.cs, tcfg.ch))
+			{
+				std::cout << "buildNavigation: Could not create solid heightfield." << std::endl;
+				return false;
+			}
 
-		// Set the area where the navigation will be build.
-		// Here the bounds of the input mesh are used, but the
-		// area could be specified by an user defined box, etc.
-		rcVcopy(state.navigation->m_cfg.bmin, bmin);
-		rcVcopy(state.navigation->m_cfg.bmax, bmax);
-		rcCalcGridSize(state.navigation->m_cfg.bmin, state.navigation->m_cfg.bmax, state.navigation->m_cfg.cs, &state.navigation->m_cfg.width, &state.navigation->m_cfg.height);
+			// Every cell takes the walkability of the board tile below its center
+			for (int y = 0; y < tcfg.height; y++)
+			{
+				for (int x = 0; x < tcfg.width; x++)
+				{
+					int boardX = static_cast<int>(std::floor(tcfg.bmin[0] + (x + 0.5f) * tcfg.cs));
+					int boardY = static_cast<int>(std::floor(tcfg.bmin[2] + (y + 0.5f) * tcfg.cs));
+					if (board.isInBounds(boardX, boardY) && board.get(boardX, boardY).isWalkable)
+						rcAddSpan(&navigation.m_ctx, *solid, x, y, 0, 5, RC_WALKABLE_AREA, 0);
+				}
+			}
 
-		//// Reset build times gathering.
-		state.navigation->m_ctx.resetTimers();
+			// Filter walkables surfaces.
+			if (navigation.config.m_filterLowHangingObstacles)
+				rcFilterLowHangingWalkableObstacles(&navigation.m_ctx, tcfg.walkableClimb, *solid);
+			if (navigation.config.m_filterLedgeSpans)
+				rcFilterLedgeSpans(&navigation.m_ctx, tcfg.walkableHeight, tcfg.walkableClimb, *solid);
+			if (navigation.config.m_filterWalkableLowHeightSpans)
+				rcFilterWalkableLowHeightSpans(&navigation.m_ctx, tcfg.walkableHeight, *solid);
+
+			// Compact the heightfield so that it is faster to handle from now on.
+			std::unique_ptr<rcCompactHeightfield, decltype(&rcFreeCompactHeightfield)> chf(rcAllocCompactHeightfield(), &rcFreeCompactHeightfield);
+			if (!chf || !rcBuildCompactHeightfield(&navigation.m_ctx, tcfg.walkableHeight, tcfg.walkableClimb, *solid, *chf))
+			{
+				std::cout << "buildNavigation: Could not build compact data." << std::endl;
+				return false;
+			}
 
-		// Start the build process.	
-		state.navigation->m_ctx.startTimer(RC_TIMER_TOTAL);
+			// Erode the walkable area by agent radius.
+			if (navigation.config.m_erodeWalkableArea && !rcErodeWalkableArea(&navigation.m_ctx, tcfg.walkableRadius, *chf))
+			{
+				std::cout << "buildNavigation: Could not erode." << std::endl;
+				return false;
+			}
 
-		//
-		// Step 2. Rasterize input polygon soup.
-		//
+			// The tile cache partitions and triangulates the layers itself
+			std::unique_ptr<rcHeightfieldLayerSet, decltype(&rcFreeHeightfieldLayerSet)> lset(rcAllocHeightfieldLayerSet(), &rcFreeHeightfieldLayerSet);
+			if (!lset || !rcBuildHeightfieldLayers(&navigation.m_ctx, *chf, tcfg.borderSize, tcfg.walkableHeight, *lset))
+			{
+				std::cout << "buildNavigation: Could not build heightfield layers." << std::endl;
+				return false;
+			}
 
-		// Allocate voxel heightfield where we rasterize our input data to.
-		state.navigation->m_solid = rcAllocHeightfield();
+			for (int i = 0; i < rcMin(lset->nlayers, MAX_LAYERS); i++)
+			{
+				const auto& layer = lset->layers[i];
+
+				// Store header
+				dtTileCacheLayerHeader header;
+				header.magic = DT_TILECACHE_MAGIC;
+				header.version = DT_TILECACHE_VERSION;
+
+				// Tile layer location in the navmesh.
+				header.tx = tx;
+				header.ty = ty;
+				header.tlayer = i;
+				dtVcopy(header.bmin, layer.bmin);
+				dtVcopy(header.bmax, layer.bmax);
+
+				// Tile info.
+				header.width = static_cast<unsigned char>(layer.width);
+				header.height = static_cast<unsigned char>(layer.height);
+				header.minx = static_cast<unsigned char>(layer.minx);
+				header.maxx = static_cast<unsigned char>(layer.maxx);
+				header.miny = static_cast<unsigned char>(layer.miny);
+				header.maxy = static_cast<unsigned char>(layer.maxy);
+				header.hmin = static_cast<unsigned short>(layer.hmin);
+				header.hmax = static_cast<unsigned short>(layer.hmax);
+
+				unsigned char* data = 0;
+				int dataSize = 0;
+				if (dtStatusFailed(dtBuildTileCacheLayer(&navigation.m_tileCompressor, &header, layer.heights, layer.areas, layer.cons, &data, &dataSize)))
+				{
+					std::cout << "buildNavigation: Could not build tile cache layer." << std::endl;
+					for (auto& builtLayer : layers)
+						dtFree(builtLayer.first);
+					layers.clear();
+					return false;
+				}
+				layers.emplace_back(data, dataSize);
+			}
 
-		if (!state.navigation->m_solid)
-		{
-			std::cout << "buildNavigation: Out of memory 'solid'." << std::endl;
-			return false;
+			return true;
 		}
 
-		if (!rcCreateHeightfield(&state.navigation->m_ctx, *state.navigation->m_solid, state.navigation->m_cfg.width, state.navigation->m_cfg.height, state.navigation->m_cfg.bmin, state.navigation->m_cfg.bmax, state.navigation->m_cfg.cs, state.navigation->m_cfg.ch))
+		// Queues the navmesh tiles overlapping the area, unless they are queued already
+		void queueTiles(const Navigation& navigation, std::deque<Vector2i>& tiles, float minX, float minY, float maxX, float maxY)
 		{
-			std::cout << "buildNavigation: Could not create solid heightfield." << std::endl;
-			return false;
+			const auto& cfg = navigation.m_cfg;
+			const float tileWidth = cfg.tileSize * cfg.cs;
+			const int minTileX = rcMax(0, static_cast<int>(std::floor((minX - cfg.bmin[0]) / tileWidth)));
+			const int maxTileX = rcMin(navigation.m_tileCountX - 1, static_cast<int>(std::floor((maxX - cfg.bmin[0]) / tileWidth)));
+			const int minTileY = rcMax(0, static_cast<int>(std::floor((minY - cfg.bmin[2]) / tileWidth)));
+			const int maxTileY = rcMin(navigation.m_tileCountY - 1, static_cast<int>(std::floor((maxY - cfg.bmin[2]) / tileWidth)));
+			for (int ty = minTileY; ty <= maxTileY; ty++)
+			{
+				for (int tx = minTileX; tx <= maxTileX; tx++)
+				{
+					Vector2i tile(tx, ty);
+					if (std::find(tiles.begin(), tiles.end(), tile) == tiles.end())
+						tiles.emplace_back(tile);
+				}
+			}
 		}
 
-		// Where hf is a reference to an heightfield object.
-		const float* orig = state.navigation->m_solid->bmin;
-		const float cs = state.navigation->m_solid->cs;
-		const float ch = state.navigation->m_solid->ch;
-		const int w = state.navigation->m_solid->width;
-		const int h = state.navigation->m_solid->height;
-
-
-		for (float x = 0; x < w; x++)
+		// Navmeshes of the NavigationCache are shared between games, the state gets its own copy before changing it.
+		// The grid pathfinder is shared by all copies of the state instead, it is copied unless no other copy uses it anymore
+		Navigation& getModifiableNavigation(RTSGameState& state)
 		{
-			for (float y = 0; y < h; y++)
+			if (state.navigation->gridPathfinder != nullptr)
 			{
-				int pos = (y * width + x);
-				auto& tile = board.get(x, y);
-
-				if (tile.isWalkable)
-					rcAddSpan(&state.navigation->m_ctx, *state.navigation->m_solid, x, y, 0, 5, RC_WALKABLE_AREA, 0);
+				if (state.navigation.use_count() > 1)
+				{
+					auto navigation = std::make_shared<Navigation>();
+					navigation->config = state.navigation->config;
+					navigation->gridPathfinder = std::make_unique<GridPathfinder>(*state.navigation->gridPathfinder);
+					state.navigation = std::move(navigation);
+				}
+			}
+			else if (state.navigation->m_shared)
+			{
+				state.navigation = NavigationCache::copy(*state.navigation);
 			}
+			return *state.navigation;
 		}
 
-		//
-		// Step 3. Filter walkables surfaces.
-		//
-
-		// Once all geoemtry is rasterized, we do initial pass of filtering to
-		// remove unwanted overhangs caused by the conservative rasterization
-		// as well as filter spans where the character cannot possibly stand.
-		if (state.navigation->config.m_filterLowHangingObstacles)
-			rcFilterLowHangingWalkableObstacles(&state.navigation->m_ctx, state.navigation->m_cfg.walkableClimb, *state.navigation->m_solid);
-		if (state.navigation->config.m_filterLedgeSpans)
-			rcFilterLedgeSpans(&state.navigation->m_ctx, state.navigation->m_cfg.walkableHeight, state.navigation->m_cfg.walkableClimb, *state.navigation->m_solid);
-		if (state.navigation->config.m_filterWalkableLowHeightSpans)
-			rcFilterWalkableLowHeightSpans(&state.navigation->m_ctx, state.navigation->m_cfg.walkableHeight, *state.navigation->m_solid);
-
-		//
-		// Step 4. Partition walkable surface to simple regions.
-		//
-
-		// Compact the heightfield so that it is faster to handle from now on.
-		// This will result more cache coherent data as well as the neighbours
-		// between walkable cells will be calculated.
-		state.navigation->m_chf = rcAllocCompactHeightfield();
-		if (!state.navigation->m_chf)
+		// Rebuilds a tile of the navmesh after the walkability of the board changed
+		void rebuildNavMeshTile(const Grid2D<Tile>& board, Navigation& navigation, int tx, int ty)
 		{
-			std::cout << "buildNavigation: Out of memory 'chf'." << std::endl;
-			return false;
-		}
-		if (!rcBuildCompactHeightfield(&state.navigation->m_ctx, state.navigation->m_cfg.walkableHeight, state.navigation->m_cfg.walkableClimb, *state.navigation->m_solid, *state.navigation->m_chf))
-		{
-			std::cout << "buildNavigation: Could not build compact data." << std::endl;
-			return false;
-		}
-
-		// Erode the walkable area by agent radius.
-		if (state.navigation->config.m_erodeWalkableArea)
-			if (!rcErodeWalkableArea(&state.navigation->m_ctx, state.navigation->m_cfg.walkableRadius, *state.navigation->m_chf))
+			std::vector<std::pair<unsigned char*, int>> layers;
+			if (!buildTileCacheLayers(board, navigation, tx, ty, layers))
+				return;
+
+			auto& tileCache = *navigation.m_tileCache;
+			auto& navMesh = *navigation.m_navMesh;
+			dtCompressedTileRef oldTiles[MAX_LAYERS];
+			const int oldTileCount = tileCache.getTilesAt(tx, ty, oldTiles, MAX_LAYERS);
+			const int newTileCount = static_cast<int>(layers.size());
+
+			// Layers that exist before and after the change get their data swapped in place instead of being removed and added.
+			// An obstacle remembers the references of the layers it touches, removeTile and addTile would change them and the
+			// obstacle would no longer be applied. The swap is safe because the tile cache looks a layer up by its slot, salt
+			// and the tx, ty and tlayer of its header, and the new header has the same position and layer as the old one
+			for (int i = 0; i < rcMin(oldTileCount, newTileCount); i++)
 			{
-				std::cout << "buildNavigation: Could not erode." << std::endl;
-				return false;
+				auto* tile = tileCache.getTileAt(tx, ty, i);
+				if (tile->flags & DT_COMPRESSEDTILE_FREE_DATA)
+					dtFree(tile->data);
+
+				const int headerSize = dtAlign4(sizeof(dtTileCacheLayerHeader));
+				tile->header = reinterpret_cast<dtTileCacheLayerHeader*>(layers[i].first);
+				tile->data = layers[i].first;
+				tile->dataSize = layers[i].second;
+				tile->compressed = tile->data + headerSize;
+				tile->compressedSize = tile->dataSize - headerSize;
+				tile->flags = DT_COMPRESSEDTILE_FREE_DATA;
 			}
 
-
-		// Partition the heightfield so that we can use simple algorithm later to triangulate the walkable areas.
-		// There are 3 martitioning methods, each with some pros and cons:
-		// 1) Watershed partitioning
-		//   - the classic Recast partitioning
-		//   - creates the nicest tessellation
-		//   - usually slowest
-		//   - partitions the heightfield into nice regions without holes or overlaps
-		//   - the are some corner cases where this method creates produces holes and overlaps
-		//      - holes may appear when a small obstacles is close to large open area (triangulation can handle this)
-		//      - overlaps may occur if you have narrow spiral corridors (i.e stairs), this make triangulation to fail
-		//   * generally the best choice if you precompute the nacmesh, use this if you have large open areas
-		// 2) Monotone partioning
-		//   - fastest
-		//   - partitions the heightfield into regions without holes and overlaps (guaranteed)
-		//   - creates long thin polygons, which sometimes causes paths with detours
-		//   * use this if you want fast navmesh generation
-		// 3) Layer partitoining
-		//   - quite fast
-		//   - partitions the heighfield into non-overlapping regions
-		//   - relies on the triangulation code to cope with holes (thus slower than monotone partitioning)
-		//   - produces better triangles than monotone partitioning
-		//   - does not have the corner cases of watershed partitioning
-		//   - can be slow and create a bit ugly tessellation (still better than monotone)
-		//     if you have large open areas with small obstacles (not a problem if you use tiles)
-		//   * good choice to use for tiled navmesh with medium and small sized tiles
-
-		if (state.navigation->config.m_partitionType == SAMPLE_PARTITION_WATERSHED)
-		{
-			// Prepare for region partitioning, by calculating distance field along the walkable surface.
-			if (!rcBuildDistanceField(&state.navigation->m_ctx, *state.navigation->m_chf))
-			{
-				std::cout << "buildNavigation: Could not build distance field." << std::endl;
-				return false;
+			// Layers that disappeared are removed together with their navmesh tiles
+			for (int i = newTileCount; i < oldTileCount; i++)
+			{
+				tileCache.removeTile(tileCache.getTileRef(tileCache.getTileAt(tx, ty, i)), 0, 0);
+				navMesh.removeTile(navMesh.getTileRefAt(tx, ty, i), 0, 0);
 			}
 
-			// Partition the walkable surface into simple regions without holes.
-			if (!rcBuildRegions(&state.navigation->m_ctx, *state.navigation->m_chf, 0, state.navigation->m_cfg.minRegionArea, state.navigation->m_cfg.mergeRegionArea))
+			// New layers are only cut by obstacles added after the rebuild
+			for (int i = oldTileCount; i < newTileCount; i++)
 			{
-				std::cout << "buildNavigation: Could not build watershed regions." << std::endl;
-				return false;
+				if (dtStatusFailed(tileCache.addTile(layers[i].first, layers[i].second, DT_COMPRESSEDTILE_FREE_DATA, 0)))
+					dtFree(layers[i].first);
 			}
+
+			tileCache.buildNavMeshTilesAt(tx, ty, &navMesh);
+			navigation.updateCellPolys(tx, ty);
 		}
-		else if (state.navigation->config.m_partitionType == SAMPLE_PARTITION_MONOTONE)
+	}
+
+	bool RTSForwardModel::buildNavMesh(RTSGameState& state, NavigationConfig config) const
+	{
+		if (pathfinding == PathfindingType::Grid)
 		{
-			// Partition the walkable surface into simple regions without holes.
-			// Monotone partitioning does not need distancefield.
-			if (!rcBuildRegionsMonotone(&state.navigation->m_ctx, *state.navigation->m_chf, 0, state.navigation->m_cfg.minRegionArea, state.navigation->m_cfg.mergeRegionArea))
-			{
-				std::cout << "buildNavigation: Could not build monotone regions." << std::endl;
-				return false;
-			}
+			// Grid paths are searched on the board tiles, building the clusters is cheap enough to skip the cache
+			state.navigation = std::make_shared<Navigation>();
+			state.navigation->config = config;
+			state.navigation->gridPathfinder = std::make_unique<GridPathfinder>(state.board, config.m_gridClusterSize);
+			return true;
 		}
-		else // SAMPLE_PARTITION_LAYERS
+
+		// Games on the same board share one navmesh, it is only built once per process or once at all with a cache directory
+		const auto cacheKey = NavigationCache::computeKey(state.board, config);
+		if (auto cachedNavigation = NavigationCache::find(cacheKey, config, navMeshCacheDirectory))
 		{
-			// Partition the walkable surface into simple regions without holes.
-			if (!rcBuildLayerRegions(&state.navigation->m_ctx, *state.navigation->m_chf, 0, state.navigation->m_cfg.minRegionArea))
-			{
-				std::cout << "buildNavigation: Could not build layer regions." << std::endl;
-				return false;
-			}
+			state.navigation = std::move(cachedNavigation);
+			return true;
 		}
 
+		auto t1 = std::chrono::high_resolution_clock::now();
+
+		state.navigation = std::make_shared<Navigation>();
+		auto& navigation = *state.navigation;
+		navigation.config = config;
+
+		//Get size from current board
+		auto& board = state.board;
+		float width = board.getWidth();
+		float height = board.getHeight();
+
+		float m_meshBMin[3]{ 0,0,0 };
+		float m_meshBMax[3]{ width,10,height };
+		const float* bmin = m_meshBMin;
+		const float* bmax = m_meshBMax;
+
 		//
-		// Step 5. Trace and simplify region contours.
+		// Step 1. Initialize build config.
 		//
 
-		// Create contours.
-		state.navigation->m_cset = rcAllocContourSet();
-		if (!state.navigation->m_cset)
-		{
-			std::cout << "buildNavigation: Out of memory 'cset'." << std::endl;
-			return false;
-		}
-		if (!rcBuildContours(&state.navigation->m_ctx, *state.navigation->m_chf, state.navigation->m_cfg.maxSimplificationError, state.navigation->m_cfg.maxEdgeLen, *state.navigation->m_cset))
-		{
-			std::cout << "buildNavigation: Could not create contours." << std::endl;
-			return false;
-		}
+		// Init build configuration from GUI
+		memset(&navigation.m_cfg, 0, sizeof(navigation.m_cfg));
+
+		navigation.m_cfg.cs = navigation.config.m_cellSize;
+		navigation.m_cfg.ch = navigation.config.m_cellHeight;
+		navigation.m_cfg.walkableSlopeAngle = navigation.config.m_agentMaxSlope;
+		navigation.m_cfg.walkableHeight = (int)ceilf(navigation.config.m_agentHeight / navigation.m_cfg.ch);
+		navigation.m_cfg.walkableClimb = (int)floorf(navigation.config.m_agentMaxClimb / navigation.m_cfg.ch);
+		navigation.m_cfg.walkableRadius = (int)ceilf(navigation.config.m_agentRadius / navigation.m_cfg.cs);
+		navigation.m_cfg.maxEdgeLen = (int)(navigation.config.m_edgeMaxLen / navigation.config.m_cellSize);
+		navigation.m_cfg.maxSimplificationError = navigation.config.m_edgeMaxError;
+		navigation.m_cfg.minRegionArea = (int)rcSqr(navigation.config.m_regionMinSize);		// Note: area = size*size
+		navigation.m_cfg.mergeRegionArea = (int)rcSqr(navigation.config.m_regionMergeSize);	// Note: area = size*size
+		navigation.m_cfg.maxVertsPerPoly = (int)navigation.config.m_vertsPerPoly;
+		navigation.m_cfg.detailSampleDist = navigation.config.m_detailSampleDist < 0.9f ? 0 : navigation.config.m_cellSize * navigation.config.m_detailSampleDist;
+		navigation.m_cfg.detailSampleMaxError = navigation.config.m_cellHeight * navigation.config.m_detailSampleMaxError;
+
+		// Tiles are padded by a border, so that the agent radius is respected at the tile edges
+		navigation.m_cfg.tileSize = rcMax(MIN_TILE_SIZE, navigation.config.m_tileSize);
+		navigation.m_cfg.borderSize = navigation.m_cfg.walkableRadius + 3;
+		navigation.m_cfg.width = navigation.m_cfg.tileSize + navigation.m_cfg.borderSize * 2;
+		navigation.m_cfg.height = navigation.m_cfg.tileSize + navigation.m_cfg.borderSize * 2;
+
+		// Set the area where the navigation will be build.
+		rcVcopy(navigation.m_cfg.bmin, bmin);
+		rcVcopy(navigation.m_cfg.bmax, bmax);
+
+		int gridWidth = 0;
+		int gridHeight = 0;
+		rcCalcGridSize(navigation.m_cfg.bmin, navigation.m_cfg.bmax, navigation.m_cfg.cs, &gridWidth, &gridHeight);
+		navigation.m_tileCountX = (gridWidth + navigation.m_cfg.tileSize - 1) / navigation.m_cfg.tileSize;
+		navigation.m_tileCountY = (gridHeight + navigation.m_cfg.tileSize - 1) / navigation.m_cfg.tileSize;
 
 		//
-		// Step 6. Build polygons mesh from contours.
+		// Step 2. Initialize the tile cache and the tiled navmesh.
 		//
 
-		// Build polygon navmesh from the contours.
-		state.navigation->m_pmesh = rcAllocPolyMesh();
-		if (!state.navigation->m_pmesh)
-		{
-			std::cout << "buildNavigation: Out of memory 'pmesh'." << std::endl;
+		dtTileCacheParams tcparams;
+		memset(&tcparams, 0, sizeof(tcparams));
+		rcVcopy(tcparams.orig, bmin);
+		tcparams.cs = navigation.m_cfg.cs;
+		tcparams.ch = navigation.m_cfg.ch;
+		tcparams.width = navigation.m_cfg.tileSize;
+		tcparams.height = navigation.m_cfg.tileSize;
+		tcparams.walkableHeight = navigation.config.m_agentHeight;
+		tcparams.walkableRadius = navigation.config.m_agentRadius;
+		tcparams.walkableClimb = navigation.config.m_agentMaxClimb;
+		tcparams.maxSimplificationError = navigation.config.m_edgeMaxError;
+		tcparams.maxTiles = navigation.m_tileCountX * navigation.m_tileCountY * EXPECTED_LAYERS_PER_TILE;
+		tcparams.maxObstacles = MAX_NAVMESH_OBSTACLES;
+
+		dtNavMeshParams params;
+		memset(&params, 0, sizeof(params));
+		rcVcopy(params.orig, bmin);
+		params.tileWidth = navigation.m_cfg.tileSize * navigation.m_cfg.cs;
+		params.tileHeight = navigation.m_cfg.tileSize * navigation.m_cfg.cs;
+		const int tileBits = rcMin(static_cast<int>(dtIlog2(dtNextPow2(tcparams.maxTiles))), 14);
+		params.maxTiles = 1 << tileBits;
+		params.maxPolys = 1 << (22 - tileBits);
+
+		if (!navigation.init(tcparams, params))
 			return false;
-		}
-		if (!rcBuildPolyMesh(&state.navigation->m_ctx, *state.navigation->m_cset, state.navigation->m_cfg.maxVertsPerPoly, *state.navigation->m_pmesh))
-		{
-			std::cout << "buildNavigation: Could not triangulate contours." << std::endl;
-			return false;
-		}
 
 		//
-		// Step 7. Create detail mesh which allows to access approximate height on each polygon.
+		// Step 3. Rasterize the board into the tile cache and build the navmesh tiles from it.
 		//
 
-		state.navigation->m_dmesh = rcAllocPolyMeshDetail();
-		if (!state.navigation->m_dmesh)
+		for (int ty = 0; ty < navigation.m_tileCountY; ty++)
 		{
-			std::cout << "buildNavigation: Out of memory 'pmdtl'." << std::endl;
-			return false;
+			for (int tx = 0; tx < navigation.m_tileCountX; tx++)
+			{
+				std::vector<std::pair<unsigned char*, int>> layers;
+				if (!buildTileCacheLayers(board, navigation, tx, ty, layers))
+					return false;
+
+				for (auto& layer : layers)
+				{
+					if (dtStatusFailed(navigation.m_tileCache->addTile(layer.first, layer.second, DT_COMPRESSEDTILE_FREE_DATA, 0)))
+						dtFree(layer.first);
+				}
+			}
 		}
 
-		if (!rcBuildPolyMeshDetail(&state.navigation->m_ctx, *state.navigation->m_pmesh, *state.navigation->m_chf, state.navigation->m_cfg.detailSampleDist, state.navigation->m_cfg.detailSampleMaxError, *state.navigation->m_dmesh))
+		for (int ty = 0; ty < navigation.m_tileCountY; ty++)
 		{
-			std::cout << "buildNavigation: Could not build detail mesh." << std::endl;
-			return false;
+			for (int tx = 0; tx < navigation.m_tileCountX; tx++)
+			{
+				navigation.m_tileCache->buildNavMeshTilesAt(tx, ty, navigation.m_navMesh);
+			}
 		}
 
-		// At this point the navigation mesh data is ready
+		navigation.updateCellPolys();
 
-		//
-		// Step 8. Create Detour data from Recast poly mesh.
-		//
+		auto t2 = std::chrono::high_resolution_clock::now();
 
-		// The GUI may allow more max points per polygon than Detour can handle.
-		// Only build the detour navmesh if we do not exceed the limit.
-		if (state.navigation->m_cfg.maxVertsPerPoly <= DT_VERTS_PER_POLYGON)
-		{
-			unsigned char* navData = 0;
-			int navDataSize = 0;
-
-			// Update poly flags from areas.
-			for (int i = 0; i < state.navigation->m_pmesh->npolys; ++i)
-			{
-				state.navigation->m_pmesh->areas[i] = SAMPLE_POLYAREA_GROUND;
-				state.navigation->m_pmesh->flags[i] = SAMPLE_POLYFLAGS_WALK;
-			}
-
-			dtNavMeshCreateParams params;
-			memset(&params, 0, sizeof(params));
-			params.verts = state.navigation->m_pmesh->verts;
-			params.vertCount = state.navigation->m_pmesh->nverts;
-			params.polys = state.navigation->m_pmesh->polys;
-			params.polyAreas = state.navigation->m_pmesh->areas;
-			params.polyFlags = state.navigation->m_pmesh->flags;
-			params.polyCount = state.navigation->m_pmesh->npolys;
-			params.nvp = state.navigation->m_pmesh->nvp;
-			params.detailMeshes = state.navigation->m_dmesh->meshes;
-			params.detailVerts = state.navigation->m_dmesh->verts;
-			params.detailVertsCount = state.navigation->m_dmesh->nverts;
-			params.detailTris = state.navigation->m_dmesh->tris;
-			params.detailTriCount = state.navigation->m_dmesh->ntris;
-
-			params.walkableHeight = state.navigation->config.m_agentHeight;
-			params.walkableHeight = 2;
-			params.walkableRadius = state.navigation->config.m_agentRadius;
-			params.walkableClimb = state.navigation->config.m_agentMaxClimb;
-			params.walkableClimb = 0.89f;
-			rcVcopy(params.bmin, state.navigation->m_pmesh->bmin);
-			rcVcopy(params.bmax, state.navigation->m_pmesh->bmax);
-			params.cs = state.navigation->m_cfg.cs;
-			params.ch = state.navigation->m_cfg.ch;
-			params.buildBvTree = true;
-
-			if (!dtCreateNavMeshData(&params, &navData, &navDataSize))
-			{
-				std::cout << "Could not build Detour navmesh." << std::endl;
-				return false;
-			}
+		auto duration = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+		std::cout << "Build navmesh " << duration << std::endl;
 
-			state.navigation->m_navMesh = dtAllocNavMesh();
-			if (!state.navigation->m_navMesh)
-			{
-				dtFree(navData);
-				std::cout << "Could not create Detour navmesh" << std::endl;
-				return false;
-			}
+		state.navigation = NavigationCache::store(cacheKey, state.navigation, navMeshCacheDirectory);
+		return true;
+	}
 
-			dtStatus status;
+	void RTSForwardModel::invalidateNavMesh(RTSGameState& state, const Vector2i& boardPosition) const
+	{
+		if (state.navigation != nullptr && state.navigation->gridPathfinder != nullptr)
+		{
+			// Changing the walkability of a search copy must not change the pathfinder of the live game
+			auto& navigation = getModifiableNavigation(state);
+			navigation.flowFields.clear();
+
+			// Searches of other threads must not see the clusters while they are marked, as with the tile rebuild
+			std::unique_lock<NavMeshLock> navMeshGuard(navigation.m_navMeshLock);
+			navigation.gridPathfinder->invalidate(boardPosition);
+			return;
+		}
 
-			status = state.navigation->m_navMesh->init(navData, navDataSize, DT_TILE_FREE_DATA);
-			if (dtStatusFailed(status))
-			{
-				dtFree(navData);
-				std::cout << "Could not init Detour navmesh" << std::endl;
-				return false;
-			}
-			state.navigation->m_navQuery = dtAllocNavMeshQuery();
+		if (state.navigation == nullptr || state.navigation->m_tileCache == nullptr)
+			return;
 
-			status = state.navigation->m_navQuery->init(state.navigation->m_navMesh, 2048);
-			if (dtStatusFailed(status))
-			{
-				std::cout << "Could not init Detour navmesh query" << std::endl;
-				return false;
-			}
+		auto& navigation = getModifiableNavigation(state);
+		navigation.flowFields.clear();
+
+		// The border of the neighbouring tiles overlaps the changed board tile too
+		const float border = (navigation.m_cfg.borderSize + 1) * navigation.m_cfg.cs;
+		queueTiles(navigation, navigation.m_dirtyTiles, boardPosition.x - border, boardPosition.y - border, boardPosition.x + 1 + border, boardPosition.y + 1 + border);
+	}
 
+	dtObstacleRef RTSForwardModel::addNavMeshObstacle(RTSGameState& state, const Vector2f& position, float radius) const
+	{
+		if (state.navigation == nullptr || state.navigation->m_tileCache == nullptr)
+			return 0;
+
+		auto& navigation = getModifiableNavigation(state);
+		float pos[3]{ position.x, 0, position.y };
+		dtObstacleRef ref = 0;
+		navigation.m_tileCache->addObstacle(pos, radius, navigation.config.m_agentHeight, &ref);
+		navigation.m_obstaclesChanged = true;
+		queueTiles(navigation, navigation.m_obstacleTiles, position.x - radius, position.y - radius, position.x + radius, position.y + radius);
+		return ref;
+	}
 
+	void RTSForwardModel::removeNavMeshObstacle(RTSGameState& state, dtObstacleRef obstacle) const
+	{
+		// Shared navmeshes never contain obstacles
+		if (state.navigation == nullptr || state.navigation->m_tileCache == nullptr || state.navigation->m_shared)
+			return;
+
+		auto& navigation = *state.navigation;
+		if (const auto* removedObstacle = navigation.m_tileCache->getObstacleByRef(obstacle))
+		{
+			const auto& circle = removedObstacle->cylinder;
+			queueTiles(navigation, navigation.m_obstacleTiles, circle.pos[0] - circle.radius, circle.pos[2] - circle.radius, circle.pos[0] + circle.radius, circle.pos[2] + circle.radius);
 		}
 
-		if (state.navigation->m_navQuery)
+		navigation.m_tileCache->removeObstacle(obstacle);
+		navigation.m_obstaclesChanged = true;
+	}
+
+	bool RTSForwardModel::updateNavMesh(RTSGameState& state, double maxMilliseconds) const
+	{
+		if (state.navigation != nullptr && state.navigation->gridPathfinder != nullptr)
 		{
-			// Change costs.
-			state.navigation->m_filter.setAreaCost(SAMPLE_POLYAREA_GROUND, 1.0f);
+			// Rebuilding a cluster takes a few microseconds, so all of them are updated at once
+			auto& gridPathfinder = *state.navigation->gridPathfinder;
+			if (!gridPathfinder.isUpToDate())
+			{
+				std::unique_lock<NavMeshLock> navMeshGuard(state.navigation->m_navMeshLock);
+				gridPathfinder.update(state.board);
+			}
+			return true;
 		}
 
-		auto t2 = std::chrono::high_resolution_clock::now();
+		if (state.navigation == nullptr || state.navigation->m_tileCache == nullptr || state.navigation->m_shared)
+			return true;
 
-		auto duration = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
-		std::cout << "Build navmesh " << duration << std::endl;
+		auto& navigation = *state.navigation;
+		if (navigation.m_dirtyTiles.empty() && !navigation.m_obstaclesChanged)
+			return true;
 
-		return true;
+		// Searches of other threads wait until the tiles are rebuilt
+		std::unique_lock<NavMeshLock> navMeshGuard(navigation.m_navMeshLock);
+		auto start = std::chrono::high_resolution_clock::now();
+		auto budgetLeft = [&]()
+		{
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+			return elapsed.count() < maxMilliseconds;
+		};
+
+		// At least one tile is rebuilt per call, so that a small budget still makes progress
+		do
+		{
+			if (!navigation.m_dirtyTiles.empty())
+			{
+				auto tile = navigation.m_dirtyTiles.front();
+				navigation.m_dirtyTiles.pop_front();
+				rebuildNavMeshTile(state.board, navigation, tile.x, tile.y);
+				continue;
+			}
+
+			// Obstacles, the tile cache rebuilds one tile per update
+			bool upToDate = false;
+			navigation.m_tileCache->update(0, navigation.m_navMesh, &upToDate);
+			if (upToDate)
+			{
+				for (const auto& tile : navigation.m_obstacleTiles)
+					navigation.updateCellPolys(tile.x, tile.y);
+				navigation.m_obstacleTiles.clear();
+				navigation.m_obstaclesChanged = false;
+				return true;
+			}
+		} while (budgetLeft());
+
+		return false;
 	}
 
 	Path RTSForwardModel::findPath(const RTSGameState& state, Vector2f startPos, Vector2f endPos) const
@@ -670,24 +965,58 @@ namespace SGA
 		dtPolyRef m_parent[MAX_POLYS];
 		int m_npolys;
 
-		//Find nearest poly
-		state.navigation->m_navQuery->findNearestPoly(startPosV3, state.navigation->m_polyPickExt, &state.navigation->m_filter, &startRef, startPosV3);
-		state.navigation->m_navQuery->findNearestPoly(endPosV3, state.navigation->m_polyPickExt, &state.navigation->m_filter, &endRef, endPosV3);
-
 		Path path;
+		path.target = endPos;
+
+		// State copies of other threads search the same navmesh, every search uses its own query
+		auto& navigation = *state.navigation;
+		std::shared_lock<NavMeshLock> navMeshGuard(navigation.m_navMeshLock);
+		if (navigation.gridPathfinder != nullptr)
+		{
+			Vector2i startTile(static_cast<int>(std::floor(startPos.x)), static_cast<int>(std::floor(startPos.y)));
+			Vector2i endTile(static_cast<int>(std::floor(endPos.x)), static_cast<int>(std::floor(endPos.y)));
+			std::vector<Vector2i> corners;
+			if (!navigation.gridPathfinder->findPath(startTile, endTile, corners))
+				return path;
+
+			// The path starts at the unit and ends at the target, the corners in between are walked through the tile centers
+			const int cornerCount = std::min(static_cast<int>(corners.size()), MAX_POLYS);
+			for (int i = 0; i < cornerCount; i++)
+			{
+				Vector2f corner(corners[i].x + 0.5f, corners[i].y + 0.5f);
+				if (i == 0)
+					corner = startPos;
+				else if (i == static_cast<int>(corners.size()) - 1)
+					corner = endPos;
+
+				path.m_straightPath[i * 3] = corner.x;
+				path.m_straightPath[i * 3 + 1] = 0;
+				path.m_straightPath[i * 3 + 2] = corner.y;
+			}
+			path.m_nstraightPath = cornerCount;
+			return path;
+		}
+
+		auto query = navigation.m_queryPool.acquire();
+		if (query == nullptr)
+			return path;
+
+		//Find start and end poly
+		startRef = navigation.findPoly(*query, startPosV3);
+		endRef = navigation.findPoly(*query, endPosV3);
 
 		if (startRef && endRef)
 		{
-			state.navigation->m_navQuery->findPath(startRef, endRef, startPosV3, endPosV3, &state.navigation->m_filter, m_polys, &m_npolys, MAX_POLYS);
+			query->findPath(startRef, endRef, startPosV3, endPosV3, &navigation.m_filter, m_polys, &m_npolys, MAX_POLYS);
 			path.m_nstraightPath = 0;
 			if (m_npolys)
 			{
 				// In case of partial path, make sure the end point is clamped to the last polygon.			
 
 				if (m_polys[m_npolys - 1] != endRef)
-					state.navigation->m_navQuery->closestPointOnPoly(m_polys[m_npolys - 1], endPosV3, endPosV3, 0);
+					query->closestPointOnPoly(m_polys[m_npolys - 1], endPosV3, endPosV3, 0);
 
-				state.navigation->m_navQuery->findStraightPath(startPosV3, endPosV3, m_polys, m_npolys,
+				query->findStraightPath(startPosV3, endPosV3, m_polys, m_npolys,
 					path.m_straightPath, path.m_straightPathFlags,
 					path.m_straightPathPolys, &path.m_nstraightPath, MAX_POLYS, path.m_straightPathOptions);
 			}
@@ -700,6 +1029,96 @@ namespace SGA
 		return path;
 	}
 
+	namespace
+	{
+		// Fallback if no path could be found, the unit walks straight towards the target
+		Path straightPath(const Vector2f& startPos, const Vector2f& endPos)
+		{
+			Path path;
+			path.m_straightPath[0] = startPos.x;
+			path.m_straightPath[2] = startPos.y;
+			path.m_straightPath[3] = endPos.x;
+			path.m_straightPath[5] = endPos.y;
+			path.m_nstraightPath = 2;
+			path.target = endPos;
+			return path;
+		}
+	}
+
+	bool RTSForwardModel::updatePath(RTSGameState& state, Entity& unit, const Vector2f& targetPos) const
+	{
+		auto& path = unit.path;
+		// Grid searches are fast enough to be resolved right away
+		if (state.pathRequests == nullptr || pathfinding == PathfindingType::Grid)
+		{
+			//Check if path is empty or is a different path to the target pos
+			if (path.m_nstraightPath == 0 || targetPos != path.target)
+			{
+				path = findPath(state, unit.position, targetPos);
+				path.currentPathIndex++;
+			}
+			return false;
+		}
+
+		auto& pathRequests = *state.pathRequests;
+		if (path.pathRequest != -1)
+		{
+			if (path.pathRequestTarget == targetPos)
+			{
+				auto status = pathRequests.getRequestStatus(path.pathRequest);
+				if (dtStatusInProgress(status))
+					return true;
+
+				// Unknown requests were dropped by the queue, they are requested again below
+				if (!dtStatusDetail(status, DT_INVALID_PARAM))
+				{
+					Path newPath;
+					if (!dtStatusSucceed(status) || !pathRequests.getPathResult(path.pathRequest, unit.position, newPath))
+						newPath = straightPath(unit.position, targetPos);
+
+					newPath.target = targetPos;
+					newPath.currentPathIndex++;
+					path = newPath;
+					return false;
+				}
+			}
+			else
+			{
+				pathRequests.cancel(path.pathRequest);
+			}
+			path.pathRequest = -1;
+		}
+
+		//Check if path is empty or is a different path to the target pos
+		if (path.m_nstraightPath == 0 || targetPos != path.target)
+		{
+			path.pathRequest = pathRequests.request(state.navigation, unit.position, targetPos);
+			path.pathRequestTarget = targetPos;
+			if (path.pathRequest != -1)
+				return true;
+
+			path = straightPath(unit.position, targetPos);
+			path.currentPathIndex++;
+		}
+		return false;
+	}
+
+	Vector2f RTSForwardModel::followFlowField(const RTSGameState& state, const Vector2f& position, const Vector2f& targetPos) const
+	{
+		if (state.navigation == nullptr)
+			return targetPos;
+
+		Vector2i targetTile(static_cast<int>(std::floor(targetPos.x)), static_cast<int>(std::floor(targetPos.y)));
+		auto flowField = state.navigation->flowFields.getFlowField(state.board, targetTile);
+
+		//Walk to the center of the next tile, the last tile is walked straight
+		Vector2i nextTile;
+		if (!flowField->getNextTile(position, nextTile))
+			return targetPos;
+		
+		return Vector2f(nextTile.x + 0.5f, nextTile.y + 0.5f);
+	}
+
 	bool RTSForwardModel::checkGameIsFinished(RTSGameState& state) const
 	{
 		/*int numberPlayerCanPlay = 0;
@@ -1,9 +1,16 @@
 #include <Stratega/Game/RTSGame.h>
+#include <Stratega/Game/RTSGameCommunicator.h>
+#include <Stratega/Agent/Agent.h>
+
 namespace SGA
 {
 	RTSGame::RTSGame(std::unique_ptr<RTSGameState> gameState, RTSForwardModel forwardModel, std::mt19937 rngEngine)
 		: Game(rngEngine), gameState(std::move(gameState)), forwardModel(std::move(forwardModel))
 	{
+		// The live game resolves paths asynchronously, the copies of the agents keep using the synchronous findPath
+		this->gameState->pathRequests = std::make_unique<PathRequestQueue>();
+		if (this->forwardModel.locomotion == LocomotionType::Crowd)
+			this->gameState->crowd = std::make_unique<CrowdSimulation>(this->forwardModel.crowdConfig);
 	}
 
 	const RTSGameState& RTSGame::getState() const
@@ -17,43 +24,132 @@ namespace SGA
 		return *gameState;
 	}
 
+	int RTSGame::getCurrentTick()
+	{
+		std::lock_guard<std::mutex> tickGuard(stateMutex);
+		return gameState->currentTick;
+	}
+
+	RTSGameMetrics RTSGame::getMetrics()
+	{
+		std::lock_guard<std::mutex> copyGuard(stateMutex);
+		return metrics;
+	}
+
+	void RTSGame::buildNavMesh(NavigationConfig config)
+	{
+		std::lock_guard<std::mutex> navmeshGuard(stateMutex);
+		navigationConfig = config;
+		forwardModel.buildNavMesh(*gameState, navigationConfig);
+		shouldUpdateNavmesh = false;
+	}
+
+	void RTSGame::addCommunicator(std::shared_ptr<GameCommunicator> comm)
+	{
+		// Only agents take part in the lockstep, loggers and renderers just observe the game
+		if (dynamic_cast<RTSGameCommunicator*>(comm.get()) != nullptr)
+		{
+			std::lock_guard<std::mutex> lockstepGuard(lockstepMutex);
+			lockstepPlayers.emplace(comm->getPlayerID());
+		}
+
+		Game::addCommunicator(std::move(comm));
+	}
+
+	void RTSGame::removeLockstepPlayer(int playerID)
+	{
+		std::lock_guard<std::mutex> lockstepGuard(lockstepMutex);
+		lockstepPlayers.erase(playerID);
+		lockstepCondition.notify_all();
+	}
+
 	void RTSGame::update(double deltaTime)
 	{
-		accumulatedTimeUpdate += deltaTime;
-		accumulatedTimePrint += deltaTime;
+		elapsedRealTime += deltaTime;
+		accumulatedTimeUpdate += deltaTime * speedMultiplier;
 
-		if (accumulatedTimeUpdate > forwardModel.deltaTime)
+		const bool timeElapsed = unthrottled || accumulatedTimeUpdate >= forwardModel.deltaTime;
+		if (timeElapsed && (!lockstep || allPlayersFinishedTick()))
 		{
-			//Execute
-			stateMutex.lock();
-			forwardModel.advanceGameState(*gameState, Action::createEndAction(-1));
+			advanceTick();
+			// Keep the remainder to honour the speedMultiplier, but never build up a backlog of ticks
+			accumulatedTimeUpdate = unthrottled ? 0 : std::min(accumulatedTimeUpdate - forwardModel.deltaTime, static_cast<double>(forwardModel.deltaTime));
+		}
 
-			//Update navmesh if it needs to
-			if (shouldUpdateNavmesh)
-			{
-				forwardModel.buildNavMesh(*gameState, navigationConfig);
-				shouldUpdateNavmesh = false;
-			}
+		updateMetrics(deltaTime);
+	}
 
-			stateMutex.unlock();
+	void RTSGame::advanceTick()
+	{
+		//Execute
+		stateMutex.lock();
+		forwardModel.advanceGameState(*gameState, Action::createEndAction(-1));
+		int ticks = 1;
+		if (unthrottled && skipIdleTicks)
+		{
+			ticks += forwardModel.fastForward(*gameState, maxSkippedTicks);
+		}
 
-			for (auto& com : communicators)
-			{
-				com->onGameStateAdvanced();
-			}
+		//Update navmesh if it needs to
+		if (shouldUpdateNavmesh)
+		{
+			forwardModel.buildNavMesh(*gameState, navigationConfig);
+			shouldUpdateNavmesh = false;
+		}
+		else
+		{
+			forwardModel.updateNavMesh(*gameState, navmeshUpdateBudget);
+		}
 
-			accumulatedTimeUpdate = 0;
-			executionCount++;
+		metrics.totalTicks += ticks;
+		metrics.simulatedTime += ticks * forwardModel.deltaTime;
+		metrics.realTime = elapsedRealTime;
+		stateMutex.unlock();
+
+		// Release the agents waiting for this tick
+		if (lockstep)
+		{
+			std::lock_guard<std::mutex> lockstepGuard(lockstepMutex);
+			finishedPlayers.clear();
+			lockstepTick++;
+			lockstepCondition.notify_all();
 		}
 
-		if (accumulatedTimePrint >= 1)
+		for (auto& com : communicators)
+		{
+			com->onGameStateAdvanced();
+		}
+
+		executionCount += ticks;
+	}
+
+	bool RTSGame::allPlayersFinishedTick()
+	{
+		std::unique_lock<std::mutex> lockstepLock(lockstepMutex);
+		auto allFinished = [&]()
 		{
-			std::cout << "Advanced " << executionCount << " times the forwardModel in " << accumulatedTimePrint << "s." << std::endl;
-			for (const auto& unit : gameState->entities)
+			for (auto playerID : lockstepPlayers)
 			{
-				std::cout << "Unit " << unit.id << " at position (" << unit.position.x << ", " << unit.position.y << ")" << std::endl;
+				if (finishedPlayers.find(playerID) == finishedPlayers.end())
+					return false;
 			}
+			return true;
+		};
 
+		// Do not spin while the agents are thinking, Game::run calls us again anyway
+		return lockstepCondition.wait_for(lockstepLock, std::chrono::milliseconds(1), allFinished);
+	}
+
+	void RTSGame::updateMetrics(double deltaTime)
+	{
+		accumulatedTimePrint += deltaTime;
+		if (accumulatedTimePrint >= 1)
+		{
+			std::lock_guard<std::mutex> metricsGuard(stateMutex);
+			metrics.realTime = elapsedRealTime;
+			metrics.ticksLastSecond = executionCount;
+			metrics.ticksPerSecond = executionCount / accumulatedTimePrint;
+			metrics.speedup = metrics.ticksPerSecond * forwardModel.deltaTime;
 
 			executionCount = 0;
 			accumulatedTimePrint = 0;
@@ -62,6 +158,13 @@ namespace SGA
 
 	void RTSGame::close()
 	{
+		// Wake up agents that are still waiting for the next tick
+		{
+			std::lock_guard<std::mutex> lockstepGuard(lockstepMutex);
+			lockstepTick++;
+			lockstepCondition.notify_all();
+		}
+		
 		Game::close();
 
 		std::cout << "GAME IS FINISHED" << std::endl;
@@ -71,7 +174,18 @@ namespace SGA
 	void RTSGame::executeAction(Action action)
 	{
 		if (action.actionTypeFlags==EndTickAction)
+		{
+			if (!lockstep)
+				return;
+
+			// The agent is done with this tick, block until the game advanced
+			std::unique_lock<std::mutex> lockstepLock(lockstepMutex);
+			const int tick = lockstepTick;
+			finishedPlayers.emplace(action.ownerID);
+			lockstepCondition.notify_all();
+			lockstepCondition.wait(lockstepLock, [&]() { return lockstepTick != tick || isGameOver(); });
 			return;
+		}
 
 		std::lock_guard<std::mutex> stateGuard(stateMutex);
 		forwardModel.advanceGameState(*gameState, action);
@@ -9,7 +9,12 @@ namespace SGA
 		RTSForwardModel copy(game->getForwardModel());
 		copy.setActionSpace(copy.generateDefaultActionSpace());
 
-		thread = std::thread(&Agent::runRTS, std::ref(*agent), std::ref(*this), std::move(copy));
+		thread = std::thread([this, copy = std::move(copy)]() mutable
+		{
+			agent->runRTS(*this, std::move(copy));
+			// An agent that stopped playing must not stall the lockstep
+			game->removeLockstepPlayer(getPlayerID());
+		});
 	}
 
 	void RTSGameCommunicator::setGame(RTSGame& newGame)
@@ -40,8 +45,18 @@ namespace SGA
 		return state;
 	}
 
+	int RTSGameCommunicator::getCurrentTick() const
+	{
+		return game->getCurrentTick();
+	}
+
 	bool RTSGameCommunicator::isGameOver() const
 	{
 		return game->isGameOver();
 	}
+
+	bool RTSGameCommunicator::isLockstep() const
+	{
+		return game->lockstep;
+	}
 }
@@ -0,0 +1,240 @@
+#include <Stratega/Representation/CrowdSimulation.h>
+#include <Stratega/Representation/RTSGameState.h>
+#include <Stratega/ForwardModel/ActionType.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <unordered_set>
+
+namespace SGA
+{
+	namespace
+	{
+		const float AGENT_HEIGHT = 2.f;
+		// Agents closer to their target than this part of their radius have arrived
+		const float ARRIVAL_DISTANCE = 0.25f;
+		// Agents that can not get closer to their target, because other units stand there, arrive after standing still for a while
+		const float BLOCKED_DISTANCE = 4.f;
+		const float BLOCKED_SPEED = 0.1f;
+		const int BLOCKED_TICKS = 10;
+		// Entities further away from their agent were moved by something else than the crowd
+		const float TELEPORT_DISTANCE = 0.001f;
+	}
+
+	CrowdSimulation::CrowdSimulation(const CrowdConfig& config)
+		: config(config),
+		  crowd(dtAllocCrowd())
+	{
+	}
+
+	CrowdSimulation::~CrowdSimulation()
+	{
+		dtFreeCrowd(crowd);
+	}
+
+	bool CrowdSimulation::init(const RTSGameState& state)
+	{
+		navigation = state.navigation;
+		agents.clear();
+		if (navigation == nullptr || navigation->m_navMesh == nullptr)
+			return false;
+
+		float maxAgentRadius = 0.5f;
+		for (const auto& entity : state.entities)
+			maxAgentRadius = std::max(maxAgentRadius, entity.collisionRadius);
+
+		if (!crowd->init(config.maxAgents, maxAgentRadius, navigation->m_navMesh))
+		{
+			std::cout << "CrowdSimulation: Could not init crowd." << std::endl;
+			navigation = nullptr;
+			return false;
+		}
+		*crowd->getEditableFilter(0) = navigation->m_filter;
+
+		// Sampling patterns of the obstacle avoidance from low to high quality, the same as in the Recast demo
+		const unsigned char avoidanceSampling[4][3] = { { 5, 2, 1 }, { 5, 2, 2 }, { 7, 2, 3 }, { 7, 3, 3 } };
+		dtObstacleAvoidanceParams params;
+		memcpy(&params, crowd->getObstacleAvoidanceParams(0), sizeof(dtObstacleAvoidanceParams));
+		for (int i = 0; i < 4; i++)
+		{
+			params.velBias = 0.5f;
+			params.adaptiveDivs = avoidanceSampling[i][0];
+			params.adaptiveRings = avoidanceSampling[i][1];
+			params.adaptiveDepth = avoidanceSampling[i][2];
+			crowd->setObstacleAvoidanceParams(i, &params);
+		}
+		return true;
+	}
+
+	bool CrowdSimulation::canMove(const RTSGameState& state, int entityTypeID)
+	{
+		auto it = movableTypes.find(entityTypeID);
+		if (it != movableTypes.end())
+			return it->second;
+
+		bool movable = false;
+		for (int actionTypeID : state.getEntityType(entityTypeID).actionIds)
+		{
+			for (const auto& effect : state.actionTypes->at(actionTypeID).effects)
+				movable |= dynamic_cast<const Move*>(effect.get()) != nullptr;
+		}
+
+		movableTypes.emplace(entityTypeID, movable);
+		return movable;
+	}
+
+	void CrowdSimulation::addAgent(const Entity& entity)
+	{
+		dtCrowdAgentParams params;
+		memset(&params, 0, sizeof(params));
+		params.radius = entity.collisionRadius;
+		params.height = AGENT_HEIGHT;
+		params.maxSpeed = static_cast<float>(entity.movementSpeed);
+		params.maxAcceleration = params.maxSpeed * 8;
+		params.collisionQueryRange = params.radius * 12;
+		params.pathOptimizationRange = params.radius * 30;
+		params.separationWeight = config.separationWeight;
+		params.updateFlags = DT_CROWD_ANTICIPATE_TURNS | DT_CROWD_OPTIMIZE_VIS | DT_CROWD_OPTIMIZE_TOPO | DT_CROWD_OBSTACLE_AVOIDANCE | DT_CROWD_SEPARATION;
+		params.obstacleAvoidanceType = static_cast<unsigned char>(std::clamp(config.avoidanceQuality, 0, 3));
+
+		// The navmesh surface is above the board, the agent is placed onto it
+		float pos[3]{ entity.position.x, 0, entity.position.y };
+		navigation->findPoly(*crowd->getNavMeshQuery(), pos);
+
+		// A full crowd leaves the unit to the path following of Move
+		const int index = crowd->addAgent(pos, &params);
+		if (index == -1)
+			return;
+
+		agents.emplace(entity.id, Agent{ index, entity.position, entity.position, false, false, 0 });
+	}
+
+	void CrowdSimulation::sync(const RTSGameState& state)
+	{
+		// The navmesh was rebuilt or copied, the agents are added again on the new one
+		if (state.navigation != navigation)
+			init(state);
+		if (navigation == nullptr || navigation->m_navMesh == nullptr)
+			return;
+
+		std::shared_lock<NavMeshLock> navMeshGuard(navigation->m_navMeshLock);
+		std::unordered_set<int> entityIDs;
+		for (const auto& entity : state.entities)
+		{
+			entityIDs.emplace(entity.id);
+			auto it = agents.find(entity.id);
+			if (it != agents.end())
+			{
+				if ((entity.position - it->second.position).magnitude() <= TELEPORT_DISTANCE)
+					continue;
+
+				crowd->removeAgent(it->second.index);
+				agents.erase(it);
+				addAgent(entity);
+			}
+			else if (canMove(state, entity.typeID))
+			{
+				addAgent(entity);
+			}
+		}
+
+		for (auto it = agents.begin(); it != agents.end();)
+		{
+			if (entityIDs.find(it->first) == entityIDs.end())
+			{
+				crowd->removeAgent(it->second.index);
+				it = agents.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	bool CrowdSimulation::moveTo(const Entity& unit, const Vector2f& target)
+	{
+		auto it = agents.find(unit.id);
+		if (it == agents.end())
+			return false;
+
+		auto& agent = it->second;
+		agent.moveRequested = true;
+		const float distance = (target - agent.position).magnitude();
+		const bool sameTarget = agent.hasTarget && agent.target == target;
+		if (distance <= unit.collisionRadius * ARRIVAL_DISTANCE || (sameTarget && agent.blockedTicks >= BLOCKED_TICKS && distance <= unit.collisionRadius * BLOCKED_DISTANCE))
+		{
+			crowd->resetMoveTarget(agent.index);
+			agent.hasTarget = false;
+			return true;
+		}
+
+		if (sameTarget)
+			return false;
+
+		std::shared_lock<NavMeshLock> navMeshGuard(navigation->m_navMeshLock);
+		float pos[3]{ target.x, 0, target.y };
+		const auto targetRef = navigation->findPoly(*crowd->getNavMeshQuery(), pos);
+		// Targets outside of the navmesh can not be reached
+		if (!targetRef)
+		{
+			crowd->resetMoveTarget(agent.index);
+			agent.hasTarget = false;
+			return true;
+		}
+
+		crowd->requestMoveTarget(agent.index, targetRef, pos);
+		agent.target = target;
+		agent.hasTarget = true;
+		agent.blockedTicks = 0;
+		return false;
+	}
+
+	void CrowdSimulation::update(RTSGameState& state, float deltaTime)
+	{
+		if (agents.empty())
+			return;
+
+		// Units that stopped moving, for example because they got another order, stop their agent
+		for (auto& [entityID, agent] : agents)
+		{
+			if (!agent.moveRequested && agent.hasTarget)
+			{
+				crowd->resetMoveTarget(agent.index);
+				agent.hasTarget = false;
+			}
+			agent.moveRequested = false;
+		}
+
+		{
+			std::shared_lock<NavMeshLock> navMeshGuard(navigation->m_navMeshLock);
+			crowd->update(deltaTime, nullptr);
+		}
+
+		for (auto& entity : state.entities)
+		{
+			auto it = agents.find(entity.id);
+			if (it == agents.end())
+				continue;
+
+			auto& agent = it->second;
+			const auto* crowdAgent = crowd->getAgent(agent.index);
+			entity.position = Vector2f(crowdAgent->npos[0], crowdAgent->npos[2]);
+			agent.position = entity.position;
+
+			const bool blocked = dtVlen(crowdAgent->vel) < crowdAgent->params.maxSpeed * BLOCKED_SPEED;
+			agent.blockedTicks = agent.hasTarget && blocked ? agent.blockedTicks + 1 : 0;
+		}
+	}
+
+	bool CrowdSimulation::hasMovingAgents() const
+	{
+		for (const auto& [entityID, agent] : agents)
+		{
+			if (agent.hasTarget || dtVlen(crowd->getAgent(agent.index)->vel) > 0.001f)
+				return true;
+		}
+		return false;
+	}
+}
@@ -0,0 +1,152 @@
+#include <Stratega/Representation/FlowField.h>
+
+#include <cmath>
+#include <limits>
+#include <queue>
+
+namespace SGA
+{
+	namespace
+	{
+		const Vector2i NEIGHBOURS[8] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1} };
+		const float DIAGONAL_COST = std::sqrt(2.f);
+
+		// Diagonal moves must not cut the corners of un-walkable tiles
+		bool canMove(const Grid2D<Tile>& board, const Vector2i& from, const Vector2i& offset)
+		{
+			auto to = from + offset;
+			if (!board.isInBounds(to) || !board.get(to.x, to.y).isWalkable)
+				return false;
+
+			if (offset.x != 0 && offset.y != 0)
+			{
+				return board.get(from.x + offset.x, from.y).isWalkable && board.get(from.x, from.y + offset.y).isWalkable;
+			}
+			return true;
+		}
+	}
+
+	FlowField::FlowField(const Grid2D<Tile>& board, const Vector2i& destination)
+		: destination(destination),
+		  width(board.getWidth()),
+		  height(board.getHeight()),
+		  integrationField(board.getWidth() * board.getHeight(), std::numeric_limits<float>::infinity()),
+		  directionField(board.getWidth() * board.getHeight(), Vector2i(0, 0))
+	{
+		if (!board.isInBounds(destination))
+			return;
+
+		// Integration field, Dijkstra from the destination over the walkable tiles
+		using Entry = std::pair<float, int>;
+		std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> openList;
+		integrationField[destination.y * width + destination.x] = 0;
+		openList.emplace(0.f, destination.y * width + destination.x);
+		while (!openList.empty())
+		{
+			auto [distance, index] = openList.top();
+			openList.pop();
+			if (distance > integrationField[index])
+				continue;
+
+			Vector2i tile(index % width, index / width);
+			for (const auto& offset : NEIGHBOURS)
+			{
+				// Moves are symmetric, so the tile can be reached from the neighbour if we can move to it
+				if (!canMove(board, tile, offset))
+					continue;
+
+				auto neighbour = tile + offset;
+				auto neighbourIndex = neighbour.y * width + neighbour.x;
+				auto newDistance = distance + (offset.x != 0 && offset.y != 0 ? DIAGONAL_COST : 1.f);
+				if (newDistance < integrationField[neighbourIndex])
+				{
+					integrationField[neighbourIndex] = newDistance;
+					openList.emplace(newDistance, neighbourIndex);
+				}
+			}
+		}
+
+		// Direction field, every tile points to its neighbour with the lowest distance
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				Vector2i tile(x, y);
+				auto bestDistance = integrationField[y * width + x];
+				if (tile == destination || std::isinf(bestDistance))
+					continue;
+
+				for (const auto& offset : NEIGHBOURS)
+				{
+					if (!canMove(board, tile, offset))
+						continue;
+
+					auto neighbour = tile + offset;
+					auto neighbourDistance = integrationField[neighbour.y * width + neighbour.x];
+					if (neighbourDistance < bestDistance)
+					{
+						bestDistance = neighbourDistance;
+						directionField[y * width + x] = offset;
+					}
+				}
+			}
+		}
+	}
+
+	bool FlowField::isReachable(const Vector2i& tile) const
+	{
+		return tile.x >= 0 && tile.x < width && tile.y >= 0 && tile.y < height && !std::isinf(getDistance(tile));
+	}
+
+	bool FlowField::getNextTile(const Vector2f& position, Vector2i& nextTile) const
+	{
+		Vector2i tile(static_cast<int>(std::floor(position.x)), static_cast<int>(std::floor(position.y)));
+		if (tile == destination || !isReachable(tile))
+			return false;
+
+		nextTile = tile + getDirection(tile);
+		return true;
+	}
+
+	FlowFieldCache::FlowFieldCache(size_t capacity)
+		: capacity(capacity)
+	{
+	}
+
+	std::shared_ptr<const FlowField> FlowFieldCache::getFlowField(const Grid2D<Tile>& board, const Vector2i& destination)
+	{
+		{
+			std::lock_guard<std::mutex> cacheGuard(mutex);
+			auto it = lookup.find(destination);
+			if (it != lookup.end())
+			{
+				fields.splice(fields.begin(), fields, it->second);
+				return *it->second;
+			}
+		}
+
+		// Compute the field without blocking other users of the cache
+		auto field = std::make_shared<const FlowField>(board, destination);
+
+		std::lock_guard<std::mutex> cacheGuard(mutex);
+		auto it = lookup.find(destination);
+		if (it != lookup.end())
+			return *it->second;
+
+		fields.emplace_front(field);
+		lookup.emplace(destination, fields.begin());
+		while (fields.size() > capacity)
+		{
+			lookup.erase(fields.back()->getDestination());
+			fields.pop_back();
+		}
+		return field;
+	}
+
+	void FlowFieldCache::clear()
+	{
+		std::lock_guard<std::mutex> cacheGuard(mutex);
+		fields.clear();
+		lookup.clear();
+	}
+}
@@ -0,0 +1,562 @@
+#include <Stratega/Representation/GridPathfinder.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+namespace SGA
+{
+	namespace
+	{
+		const Vector2i NEIGHBOURS[8] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1} };
+		const float DIAGONAL_COST = std::sqrt(2.f);
+		const float INFINITE_DISTANCE = std::numeric_limits<float>::infinity();
+		// Walkable runs along a cluster border of at least this length get an entrance at both ends instead of one in the middle
+		const int LONG_ENTRANCE_LENGTH = 6;
+
+		using OpenEntry = std::pair<float, int>;
+		using OpenList = std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>>;
+
+		// Walking distance without obstacles, the heuristic of the searches
+		float octileDistance(const Vector2i& from, const Vector2i& to)
+		{
+			const int dx = std::abs(to.x - from.x);
+			const int dy = std::abs(to.y - from.y);
+			return (DIAGONAL_COST - 1.f) * std::min(dx, dy) + std::max(dx, dy);
+		}
+
+		int sign(int value)
+		{
+			return (value > 0) - (value < 0);
+		}
+	}
+
+	GridPathfinder::GridPathfinder(const Grid2D<Tile>& board, int clusterSize)
+		: width(board.getWidth()),
+		  height(board.getHeight()),
+		  clusterSize(std::max(clusterSize, 2)),
+		  clusterCountX((width + this->clusterSize - 1) / this->clusterSize),
+		  clusterCountY((height + this->clusterSize - 1) / this->clusterSize),
+		  walkable(width * height),
+		  clusters(clusterCountX * clusterCountY),
+		  entranceIndices(width * height, -1),
+		  nodeCount(0)
+	{
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				walkable[y * width + x] = board.get(x, y).isWalkable;
+			}
+		}
+
+		for (int cy = 0; cy < clusterCountY; cy++)
+		{
+			for (int cx = 0; cx < clusterCountX; cx++)
+			{
+				auto& cluster = clusters[cy * clusterCountX + cx];
+				cluster.min = Vector2i(cx * this->clusterSize, cy * this->clusterSize);
+				cluster.max = Vector2i(std::min(cluster.min.x + this->clusterSize, width) - 1, std::min(cluster.min.y + this->clusterSize, height) - 1);
+			}
+		}
+
+		for (size_t i = 0; i < clusters.size(); i++)
+			buildCluster(static_cast<int>(i));
+		numberNodes();
+	}
+
+	bool GridPathfinder::isWalkable(const Vector2i& tile) const
+	{
+		return isWalkable(tile.x, tile.y);
+	}
+
+	int GridPathfinder::getEntranceCount() const
+	{
+		return nodeCount;
+	}
+
+	void GridPathfinder::numberNodes()
+	{
+		nodeCount = 0;
+		for (auto& cluster : clusters)
+		{
+			cluster.firstNode = nodeCount;
+			nodeCount += static_cast<int>(cluster.entrances.size());
+		}
+	}
+
+	void GridPathfinder::invalidate(const Vector2i& tile)
+	{
+		if (tile.x < 0 || tile.x >= width || tile.y < 0 || tile.y >= height)
+			return;
+
+		const int clusterIndex = getClusterIndex(tile);
+		if (std::find(dirtyClusters.begin(), dirtyClusters.end(), clusterIndex) == dirtyClusters.end())
+			dirtyClusters.emplace_back(clusterIndex);
+	}
+
+	void GridPathfinder::update(const Grid2D<Tile>& board)
+	{
+		if (dirtyClusters.empty())
+			return;
+
+		// The entrances on the borders of a changed cluster change for its neighbours too
+		std::vector<int> changedClusters;
+		for (int clusterIndex : dirtyClusters)
+		{
+			const auto& cluster = clusters[clusterIndex];
+			for (int y = cluster.min.y; y <= cluster.max.y; y++)
+			{
+				for (int x = cluster.min.x; x <= cluster.max.x; x++)
+				{
+					walkable[y * width + x] = board.get(x, y).isWalkable;
+				}
+			}
+
+			const int cx = clusterIndex % clusterCountX;
+			const int cy = clusterIndex / clusterCountX;
+			for (const auto& offset : { Vector2i(0, 0), Vector2i(1, 0), Vector2i(-1, 0), Vector2i(0, 1), Vector2i(0, -1) })
+			{
+				if (cx + offset.x < 0 || cx + offset.x >= clusterCountX || cy + offset.y < 0 || cy + offset.y >= clusterCountY)
+					continue;
+
+				const int neighbourIndex = (cy + offset.y) * clusterCountX + cx + offset.x;
+				if (std::find(changedClusters.begin(), changedClusters.end(), neighbourIndex) == changedClusters.end())
+					changedClusters.emplace_back(neighbourIndex);
+			}
+		}
+		dirtyClusters.clear();
+
+		for (int clusterIndex : changedClusters)
+			buildCluster(clusterIndex);
+		numberNodes();
+	}
+
+	void GridPathfinder::buildCluster(int clusterIndex)
+	{
+		auto& cluster = clusters[clusterIndex];
+		for (const auto& entrance : cluster.entrances)
+			entranceIndices[entrance.position.y * width + entrance.position.x] = -1;
+		cluster.entrances.clear();
+
+		// Entrances on all four borders, the neighbouring cluster finds the same ones from its side
+		const int clusterWidth = cluster.max.x - cluster.min.x + 1;
+		const int clusterHeight = cluster.max.y - cluster.min.y + 1;
+		if (cluster.min.x > 0)
+			addTransitions(cluster, cluster.min, Vector2i(0, 1), Vector2i(-1, 0), clusterHeight);
+		if (cluster.max.x < width - 1)
+			addTransitions(cluster, Vector2i(cluster.max.x, cluster.min.y), Vector2i(0, 1), Vector2i(1, 0), clusterHeight);
+		if (cluster.min.y > 0)
+			addTransitions(cluster, cluster.min, Vector2i(1, 0), Vector2i(0, -1), clusterWidth);
+		if (cluster.max.y < height - 1)
+			addTransitions(cluster, Vector2i(cluster.min.x, cluster.max.y), Vector2i(1, 0), Vector2i(0, 1), clusterWidth);
+
+		// Distances between the entrances inside the cluster, the edges of the abstract graph
+		const size_t entranceCount = cluster.entrances.size();
+		cluster.distances.assign(entranceCount * entranceCount, 0);
+		const auto grid = getClusterGrid(cluster);
+		std::vector<float> tileDistances;
+		for (size_t i = 0; i + 1 < entranceCount; i++)
+		{
+			// Distances are symmetric, the last entrance knows all of them already
+			computeDistances(grid, cluster.entrances[i].position, tileDistances);
+			for (size_t j = i + 1; j < entranceCount; j++)
+			{
+				const float distance = tileDistances[grid.toIndex(cluster.entrances[j].position)];
+				cluster.distances[i * entranceCount + j] = distance;
+				cluster.distances[j * entranceCount + i] = distance;
+			}
+		}
+	}
+
+	void GridPathfinder::addTransitions(Cluster& cluster, Vector2i start, const Vector2i& direction, const Vector2i& offset, int length)
+	{
+		auto addEntrance = [&](int i)
+		{
+			Vector2i position(start.x + direction.x * i, start.y + direction.y * i);
+			auto& entranceIndex = entranceIndices[position.y * width + position.x];
+			if (entranceIndex == -1)
+			{
+				entranceIndex = static_cast<int>(cluster.entrances.size());
+				cluster.entrances.emplace_back(Entrance{ position, {} });
+			}
+			cluster.entrances[entranceIndex].transitions.emplace_back(position + offset);
+		};
+
+		// Every run of tiles that are walkable on both sides of the border is an entrance
+		int runStart = -1;
+		for (int i = 0; i <= length; i++)
+		{
+			const int x = start.x + direction.x * i;
+			const int y = start.y + direction.y * i;
+			if (i < length && isWalkable(x, y) && isWalkable(x + offset.x, y + offset.y))
+			{
+				if (runStart == -1)
+					runStart = i;
+				continue;
+			}
+
+			if (runStart == -1)
+				continue;
+
+			const int runEnd = i - 1;
+			if (runEnd - runStart + 1 >= LONG_ENTRANCE_LENGTH)
+			{
+				addEntrance(runStart);
+				addEntrance(runEnd);
+			}
+			else
+			{
+				addEntrance((runStart + runEnd) / 2);
+			}
+			runStart = -1;
+		}
+	}
+
+	GridPathfinder::ClusterGrid GridPathfinder::getClusterGrid(const Cluster& cluster) const
+	{
+		ClusterGrid grid;
+		grid.origin = Vector2i(cluster.min.x - 1, cluster.min.y - 1);
+		grid.width = cluster.max.x - cluster.min.x + 3;
+		grid.walkable.assign(grid.width * (cluster.max.y - cluster.min.y + 3), 0);
+		for (int y = cluster.min.y; y <= cluster.max.y; y++)
+		{
+			std::copy(walkable.begin() + y * width + cluster.min.x, walkable.begin() + y * width + cluster.max.x + 1, grid.walkable.begin() + grid.toIndex(Vector2i(cluster.min.x, y)));
+		}
+		return grid;
+	}
+
+	void GridPathfinder::computeDistances(const ClusterGrid& grid, const Vector2i& from, std::vector<float>& distances)
+	{
+		distances.assign(grid.walkable.size(), INFINITE_DISTANCE);
+		int offsets[8];
+		for (int i = 0; i < 8; i++)
+			offsets[i] = NEIGHBOURS[i].x + NEIGHBOURS[i].y * grid.width;
+
+		// Dijkstra over the walkable tiles of the cluster
+		OpenList openList;
+		const int fromIndex = grid.toIndex(from);
+		distances[fromIndex] = 0;
+		openList.emplace(0.f, fromIndex);
+		while (!openList.empty())
+		{
+			auto [distance, index] = openList.top();
+			openList.pop();
+			if (distance > distances[index])
+				continue;
+
+			for (int i = 0; i < 8; i++)
+			{
+				const int neighbourIndex = index + offsets[i];
+				if (!grid.walkable[neighbourIndex])
+					continue;
+
+				float newDistance = distance + 1.f;
+				if (i >= 4)
+				{
+					// Diagonal moves must not cut the corners of un-walkable tiles
+					const auto& offset = NEIGHBOURS[i];
+					if (!grid.walkable[index + offset.x] || !grid.walkable[index + offset.y * grid.width])
+						continue;
+					newDistance = distance + DIAGONAL_COST;
+				}
+
+				if (newDistance < distances[neighbourIndex])
+				{
+					distances[neighbourIndex] = newDistance;
+					openList.emplace(newDistance, neighbourIndex);
+				}
+			}
+		}
+	}
+
+	namespace
+	{
+		// Follows the direction until a tile with a forced neighbour or the end is reached, tiles are indices of the ClusterGrid
+		bool jump(const unsigned char* open, int gridWidth, int index, int dx, int dy, int end, int& jumpPoint)
+		{
+			const int step = dx + dy * gridWidth;
+			while (true)
+			{
+				if (dx != 0 && dy != 0 && (!open[index + dx] || !open[index + dy * gridWidth]))
+					return false;
+
+				index += step;
+				if (!open[index])
+					return false;
+				if (index == end)
+					break;
+
+				if (dx != 0 && dy != 0)
+				{
+					// Diagonal moves stop where one of their straight moves finds a jump point
+					int straightJumpPoint;
+					if (jump(open, gridWidth, index, dx, 0, end, straightJumpPoint) || jump(open, gridWidth, index, 0, dy, end, straightJumpPoint))
+						break;
+				}
+				else if (dx != 0)
+				{
+					if ((open[index - gridWidth] && !open[index - gridWidth - dx]) || (open[index + gridWidth] && !open[index + gridWidth - dx]))
+						break;
+				}
+				else
+				{
+					if ((open[index - 1] && !open[index - 1 - dy * gridWidth]) || (open[index + 1] && !open[index + 1 - dy * gridWidth]))
+						break;
+				}
+			}
+
+			jumpPoint = index;
+			return true;
+		}
+	}
+
+	bool GridPathfinder::jumpPointSearch(const ClusterGrid& grid, const Vector2i& start, const Vector2i& end, std::vector<Vector2i>& path)
+	{
+		const auto* open = grid.walkable.data();
+		const int startIndex = grid.toIndex(start);
+		const int endIndex = grid.toIndex(end);
+		std::vector<float> costs(grid.walkable.size(), INFINITE_DISTANCE);
+		std::vector<int> parents(grid.walkable.size(), -1);
+		OpenList openList;
+		costs[startIndex] = 0;
+		openList.emplace(octileDistance(start, end), startIndex);
+		while (!openList.empty())
+		{
+			auto [estimate, index] = openList.top();
+			openList.pop();
+			auto tile = grid.toTile(index);
+			if (estimate > costs[index] + octileDistance(tile, end) + 1e-4f)
+				continue;
+
+			if (index == endIndex)
+			{
+				path.clear();
+				for (int i = index; i != -1; i = parents[i])
+					path.emplace_back(grid.toTile(i));
+				std::reverse(path.begin(), path.end());
+				return true;
+			}
+
+			// Prune the directions that are reached shorter without passing this tile
+			Vector2i directions[8];
+			int directionCount = 0;
+			if (parents[index] == -1)
+			{
+				for (const auto& offset : NEIGHBOURS)
+					directions[directionCount++] = offset;
+			}
+			else
+			{
+				auto parent = grid.toTile(parents[index]);
+				Vector2i direction(sign(tile.x - parent.x), sign(tile.y - parent.y));
+				directions[directionCount++] = direction;
+				if (direction.x != 0 && direction.y != 0)
+				{
+					directions[directionCount++] = Vector2i(direction.x, 0);
+					directions[directionCount++] = Vector2i(0, direction.y);
+				}
+				else
+				{
+					// Forced neighbours, they are only passed to jump if they are walkable
+					const Vector2i side(direction.y, direction.x);
+					for (const auto& lateral : { side, Vector2i(-side.x, -side.y) })
+					{
+						if (!open[index + lateral.x + lateral.y * grid.width])
+							continue;
+						directions[directionCount++] = lateral;
+						directions[directionCount++] = direction + lateral;
+					}
+				}
+			}
+
+			for (int i = 0; i < directionCount; i++)
+			{
+				int jumpIndex;
+				if (!jump(open, grid.width, index, directions[i].x, directions[i].y, endIndex, jumpIndex))
+					continue;
+
+				const auto jumpPoint = grid.toTile(jumpIndex);
+				const float cost = costs[index] + octileDistance(tile, jumpPoint);
+				if (cost < costs[jumpIndex])
+				{
+					costs[jumpIndex] = cost;
+					parents[jumpIndex] = index;
+					openList.emplace(cost + octileDistance(jumpPoint, end), jumpIndex);
+				}
+			}
+		}
+
+		return false;
+	}
+
+	bool GridPathfinder::hasLineOfSight(const Vector2i& from, const Vector2i& to) const
+	{
+		// Visits every tile touched by the line between the tile centers
+		const int dx = std::abs(to.x - from.x);
+		const int dy = std::abs(to.y - from.y);
+		const int stepX = sign(to.x - from.x);
+		const int stepY = sign(to.y - from.y);
+		int x = from.x;
+		int y = from.y;
+		int ix = 0;
+		int iy = 0;
+		while (ix < dx || iy < dy)
+		{
+			const int decision = (1 + 2 * ix) * dy - (1 + 2 * iy) * dx;
+			if (decision == 0)
+			{
+				// The line passes a corner, which must not be cut
+				if (!isWalkable(x + stepX, y) || !isWalkable(x, y + stepY))
+					return false;
+				x += stepX;
+				y += stepY;
+				ix++;
+				iy++;
+			}
+			else if (decision < 0)
+			{
+				x += stepX;
+				ix++;
+			}
+			else
+			{
+				y += stepY;
+				iy++;
+			}
+
+			if (!isWalkable(x, y))
+				return false;
+		}
+		return true;
+	}
+
+	bool GridPathfinder::findPath(const Vector2i& start, const Vector2i& end, std::vector<Vector2i>& corners) const
+	{
+		corners.clear();
+		if (!isWalkable(start) || !isWalkable(end))
+			return false;
+
+		if (start == end || hasLineOfSight(start, end))
+		{
+			corners = { start, end };
+			return true;
+		}
+
+		// Connect the start and end tile to the entrances of their clusters
+		const auto& startCluster = clusters[getClusterIndex(start)];
+		const auto& endCluster = clusters[getClusterIndex(end)];
+		const auto startGrid = getClusterGrid(startCluster);
+		const auto endGrid = &startCluster == &endCluster ? startGrid : getClusterGrid(endCluster);
+		std::vector<float> startDistances;
+		std::vector<float> endDistances;
+		computeDistances(startGrid, start, startDistances);
+		computeDistances(endGrid, end, endDistances);
+
+		// A* over the entrances, the start and end tile are added as the last two nodes
+		struct Node
+		{
+			Vector2i tile;
+			float cost;
+			int parent;
+		};
+		const int startNode = nodeCount;
+		const int endNode = nodeCount + 1;
+		std::vector<Node> nodes(nodeCount + 2, Node{ Vector2i(0, 0), INFINITE_DISTANCE, -1 });
+		OpenList openList;
+		auto relax = [&](int parent, int node, const Vector2i& tile, float cost)
+		{
+			if (cost >= nodes[node].cost)
+				return;
+
+			nodes[node] = Node{ tile, cost, parent };
+			openList.emplace(cost + octileDistance(tile, end), node);
+		};
+
+		relax(-1, startNode, start, 0);
+		bool found = false;
+		while (!openList.empty())
+		{
+			auto [estimate, node] = openList.top();
+			openList.pop();
+			const auto tile = nodes[node].tile;
+			const float cost = nodes[node].cost;
+			if (estimate > cost + octileDistance(tile, end) + 1e-4f)
+				continue;
+
+			if (node == endNode)
+			{
+				found = true;
+				break;
+			}
+
+			if (node == startNode)
+			{
+				for (size_t i = 0; i < startCluster.entrances.size(); i++)
+				{
+					const auto& position = startCluster.entrances[i].position;
+					relax(node, startCluster.firstNode + static_cast<int>(i), position, startDistances[startGrid.toIndex(position)]);
+				}
+				if (&startCluster == &endCluster)
+					relax(node, endNode, end, startDistances[startGrid.toIndex(end)]);
+				continue;
+			}
+
+			const auto& cluster = clusters[getClusterIndex(tile)];
+			const int entranceIndex = node - cluster.firstNode;
+			const size_t entranceCount = cluster.entrances.size();
+			for (size_t i = 0; i < entranceCount; i++)
+				relax(node, cluster.firstNode + static_cast<int>(i), cluster.entrances[i].position, cost + cluster.distances[entranceIndex * entranceCount + i]);
+			for (const auto& transition : cluster.entrances[entranceIndex].transitions)
+				relax(node, clusters[getClusterIndex(transition)].firstNode + entranceIndices[transition.y * width + transition.x], transition, cost + 1.f);
+			if (&cluster == &endCluster)
+				relax(node, endNode, end, cost + endDistances[endGrid.toIndex(tile)]);
+		}
+
+		if (!found)
+			return false;
+
+		std::vector<Vector2i> abstractPath;
+		for (int node = endNode; node != -1; node = nodes[node].parent)
+			abstractPath.emplace_back(nodes[node].tile);
+		std::reverse(abstractPath.begin(), abstractPath.end());
+
+		// Refine the abstract path, the tiles between two nodes of the same cluster are found with jump point search
+		std::vector<Vector2i> path{ start };
+		std::vector<Vector2i> segment;
+		for (size_t i = 1; i < abstractPath.size(); i++)
+		{
+			const auto& from = abstractPath[i - 1];
+			const auto& to = abstractPath[i];
+			// The start or end tile can be an entrance itself
+			if (from == to)
+				continue;
+
+			const int fromCluster = getClusterIndex(from);
+			if (fromCluster != getClusterIndex(to))
+			{
+				path.emplace_back(to);
+				continue;
+			}
+
+			if (!jumpPointSearch(getClusterGrid(clusters[fromCluster]), from, to, segment))
+				return false;
+			path.insert(path.end(), segment.begin() + 1, segment.end());
+		}
+
+		// Skip the corners the unit can walk past in a straight line
+		corners.emplace_back(path.front());
+		size_t current = 0;
+		while (current + 1 < path.size())
+		{
+			size_t next = current + 1;
+			while (next + 1 < path.size() && hasLineOfSight(path[current], path[next + 1]))
+				next++;
+			corners.emplace_back(path[next]);
+			current = next;
+		}
+		return true;
+	}
+}
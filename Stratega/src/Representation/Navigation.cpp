@@ -0,0 +1,209 @@
+#include <Stratega/Representation/Navigation.h>
+#include "DetourNavMeshBuilder.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace SGA
+{
+	int NavigationTileCompressor::maxCompressedSize(const int bufferSize)
+	{
+		return bufferSize;
+	}
+
+	dtStatus NavigationTileCompressor::compress(const unsigned char* buffer, const int bufferSize, unsigned char* compressed, const int maxCompressedSize, int* compressedSize)
+	{
+		if (bufferSize > maxCompressedSize)
+			return DT_FAILURE | DT_BUFFER_TOO_SMALL;
+
+		std::memcpy(compressed, buffer, bufferSize);
+		*compressedSize = bufferSize;
+		return DT_SUCCESS;
+	}
+
+	dtStatus NavigationTileCompressor::decompress(const unsigned char* compressed, const int compressedSize, unsigned char* buffer, const int maxBufferSize, int* bufferSize)
+	{
+		if (compressedSize > maxBufferSize)
+			return DT_FAILURE | DT_BUFFER_TOO_SMALL;
+
+		std::memcpy(buffer, compressed, compressedSize);
+		*bufferSize = compressedSize;
+		return DT_SUCCESS;
+	}
+
+	void NavigationMeshProcess::process(dtNavMeshCreateParams* params, unsigned char* polyAreas, unsigned short* polyFlags)
+	{
+		// Update poly flags from areas.
+		for (int i = 0; i < params->polyCount; ++i)
+		{
+			if (polyAreas[i] == DT_TILECACHE_WALKABLE_AREA)
+				polyAreas[i] = SAMPLE_POLYAREA_GROUND;
+
+			polyFlags[i] = SAMPLE_POLYFLAGS_WALK;
+		}
+	}
+
+	bool Navigation::init(const dtTileCacheParams& tileCacheParams, const dtNavMeshParams& navMeshParams)
+	{
+		cleanup();
+
+		m_tileCache = dtAllocTileCache();
+		if (!m_tileCache || dtStatusFailed(m_tileCache->init(&tileCacheParams, &m_tileAlloc, &m_tileCompressor, &m_tileMeshProcess)))
+		{
+			std::cout << "Could not init tile cache" << std::endl;
+			return false;
+		}
+
+		m_navMesh = dtAllocNavMesh();
+		if (!m_navMesh || dtStatusFailed(m_navMesh->init(&navMeshParams)))
+		{
+			std::cout << "Could not init Detour navmesh" << std::endl;
+			return false;
+		}
+
+		if (!m_queryPool.init(m_navMesh, 2048))
+		{
+			std::cout << "Could not init Detour navmesh query" << std::endl;
+			return false;
+		}
+
+		// Change costs.
+		m_filter.setAreaCost(SAMPLE_POLYAREA_GROUND, 1.0f);
+
+		// Every board tile is a cell of the lookup
+		m_cellCountX = static_cast<int>(std::ceil(m_cfg.bmax[0]));
+		m_cellCountY = static_cast<int>(std::ceil(m_cfg.bmax[2]));
+		m_cellPolys.assign(static_cast<size_t>(m_cellCountX) * m_cellCountY, 0);
+		return true;
+	}
+
+	void Navigation::updateCellPolys()
+	{
+		for (int ty = 0; ty < m_tileCountY; ty++)
+		{
+			for (int tx = 0; tx < m_tileCountX; tx++)
+			{
+				updateCellPolys(tx, ty);
+			}
+		}
+	}
+
+	void Navigation::updateCellPolys(int tx, int ty)
+	{
+		auto query = m_queryPool.acquire();
+		if (query == nullptr)
+			return;
+
+		const auto* params = m_navMesh->getParams();
+		const int minX = rcMax(0, static_cast<int>(std::floor(params->orig[0] + tx * params->tileWidth)));
+		const int minY = rcMax(0, static_cast<int>(std::floor(params->orig[2] + ty * params->tileHeight)));
+		const int maxX = rcMin(m_cellCountX, static_cast<int>(std::ceil(params->orig[0] + (tx + 1) * params->tileWidth)));
+		const int maxY = rcMin(m_cellCountY, static_cast<int>(std::ceil(params->orig[2] + (ty + 1) * params->tileHeight)));
+		const float halfExtents[3]{ 0.5f, m_polyPickExt[1], 0.5f };
+		for (int y = minY; y < maxY; y++)
+		{
+			for (int x = minX; x < maxX; x++)
+			{
+				float center[3]{ x + 0.5f, 0, y + 0.5f };
+				float nearest[3];
+				float height;
+				dtPolyRef ref = 0;
+				query->findNearestPoly(center, halfExtents, &m_filter, &ref, nearest);
+
+				// Cells whose center lies next to the polygon are left to findPoly's search
+				if (ref && dtStatusFailed(query->getPolyHeight(ref, center, &height)))
+					ref = 0;
+				m_cellPolys[x + y * m_cellCountX] = ref;
+			}
+		}
+	}
+
+	dtPolyRef Navigation::findPoly(const dtNavMeshQuery& query, float* pos) const
+	{
+		const int x = static_cast<int>(std::floor(pos[0]));
+		const int y = static_cast<int>(std::floor(pos[2]));
+		if (x >= 0 && y >= 0 && x < m_cellCountX && y < m_cellCountY)
+		{
+			// Fails if pos is not inside the polygon, or if the tile was rebuilt since the lookup was filled
+			const dtPolyRef ref = m_cellPolys[x + y * m_cellCountX];
+			float height;
+			if (ref && dtStatusSucceed(query.getPolyHeight(ref, pos, &height)))
+			{
+				pos[1] = height;
+				return ref;
+			}
+		}
+
+		dtPolyRef ref = 0;
+		query.findNearestPoly(pos, m_polyPickExt, &m_filter, &ref, pos);
+		return ref;
+	}
+
+	bool NavMeshQueryPool::init(const dtNavMesh* navMesh, int maxNodes)
+	{
+		clear();
+
+		std::lock_guard<std::mutex> poolGuard(poolMutex);
+		this->navMesh = navMesh;
+		this->maxNodes = maxNodes;
+
+		// Create the first query right away, so that a broken navmesh is noticed when building it
+		auto* query = createQuery();
+		if (query == nullptr)
+			return false;
+
+		freeQueries.emplace_back(query);
+		return true;
+	}
+
+	NavMeshQueryPool::Query NavMeshQueryPool::acquire()
+	{
+		dtNavMeshQuery* query = nullptr;
+		{
+			std::lock_guard<std::mutex> poolGuard(poolMutex);
+			if (!freeQueries.empty())
+			{
+				query = freeQueries.back();
+				freeQueries.pop_back();
+			}
+			else if (navMesh == nullptr)
+			{
+				return Query(nullptr, Releaser{ this });
+			}
+		}
+
+		// All queries are in use by other threads, initializing a new one allocates its node pool
+		if (query == nullptr)
+			query = createQuery();
+
+		return Query(query, Releaser{ this });
+	}
+
+	void NavMeshQueryPool::clear()
+	{
+		std::lock_guard<std::mutex> poolGuard(poolMutex);
+		for (auto* query : freeQueries)
+			dtFreeNavMeshQuery(query);
+		freeQueries.clear();
+		navMesh = nullptr;
+	}
+
+	void NavMeshQueryPool::release(dtNavMeshQuery* query)
+	{
+		std::lock_guard<std::mutex> poolGuard(poolMutex);
+		freeQueries.emplace_back(query);
+	}
+
+	dtNavMeshQuery* NavMeshQueryPool::createQuery() const
+	{
+		auto* query = dtAllocNavMeshQuery();
+		if (query != nullptr && dtStatusFailed(query->init(navMesh, maxNodes)))
+		{
+			dtFreeNavMeshQuery(query);
+			return nullptr;
+		}
+
+		return query;
+	}
+}
@@ -0,0 +1,309 @@
+#include <Stratega/Representation/NavigationCache.h>
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace SGA::NavigationCache
+{
+	namespace
+	{
+		const int NAVMESH_CACHE_MAGIC = 'S' << 24 | 'N' << 16 | 'A' << 8 | 'V';
+		// Increase when the navmesh build or the file layout changes, old files are ignored then
+		const int NAVMESH_CACHE_VERSION = 2;
+
+		struct NavigationCacheHeader
+		{
+			int magic;
+			int version;
+			int tileCount;
+			int tileCountX;
+			int tileCountY;
+			rcConfig cfg;
+			dtTileCacheParams tileCacheParams;
+			dtNavMeshParams navMeshParams;
+		};
+
+		// FNV-1a
+		class KeyHasher
+		{
+		public:
+			template<typename T>
+			void add(const T& value)
+			{
+				const auto* bytes = reinterpret_cast<const unsigned char*>(&value);
+				for (size_t i = 0; i < sizeof(T); i++)
+				{
+					hash ^= bytes[i];
+					hash *= 1099511628211ull;
+				}
+			}
+
+			std::uint64_t hash = 14695981039346656037ull;
+		};
+
+		std::mutex cacheMutex;
+		// A navmesh is freed once no game uses it anymore, except the most recently used one.
+		// It is kept alive so that games played one after another on the same board do not build it again
+		std::unordered_map<std::uint64_t, std::weak_ptr<Navigation>> navigations;
+		std::shared_ptr<Navigation> lastNavigation;
+
+		std::shared_ptr<Navigation> findUnlocked(std::uint64_t key)
+		{
+			auto it = navigations.find(key);
+			if (it == navigations.end())
+				return nullptr;
+
+			auto navigation = it->second.lock();
+			if (navigation == nullptr)
+				navigations.erase(it);
+			else
+				lastNavigation = navigation;
+			return navigation;
+		}
+
+		void insertUnlocked(std::uint64_t key, const std::shared_ptr<Navigation>& navigation)
+		{
+			// Drop the entries of freed navmeshes, so that the map does not grow with every board seen
+			std::erase_if(navigations, [](const auto& entry) { return entry.second.expired(); });
+			navigation->m_shared = true;
+			navigations[key] = navigation;
+			lastNavigation = navigation;
+		}
+
+		std::filesystem::path getFilePath(const std::filesystem::path& directory, std::uint64_t key)
+		{
+			std::stringstream fileName;
+			fileName << "navmesh_" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+			return directory / fileName.str();
+		}
+
+		bool readFile(const std::filesystem::path& path, std::vector<unsigned char>& data)
+		{
+			std::ifstream file(path, std::ios::binary | std::ios::ate);
+			if (!file)
+				return false;
+
+			const auto size = static_cast<size_t>(file.tellg());
+			data.resize(size);
+			file.seekg(0);
+			return static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), size));
+		}
+
+		void writeFile(const std::filesystem::path& path, const std::vector<unsigned char>& data)
+		{
+			std::error_code error;
+			std::filesystem::create_directories(path.parent_path(), error);
+
+			// Write to a temporary file first, so that other processes never read a half written navmesh
+			auto tempPath = path;
+			tempPath += "." + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".tmp";
+			{
+				std::ofstream file(tempPath, std::ios::binary);
+				if (!file || !file.write(reinterpret_cast<const char*>(data.data()), data.size()))
+				{
+					std::cout << "NavigationCache: Could not write " << tempPath << std::endl;
+					std::filesystem::remove(tempPath, error);
+					return;
+				}
+			}
+
+			std::filesystem::rename(tempPath, path, error);
+			if (error)
+			{
+				std::cout << "NavigationCache: Could not write " << path << std::endl;
+				std::filesystem::remove(tempPath, error);
+			}
+		}
+	}
+
+	std::uint64_t computeKey(const Grid2D<Tile>& board, const NavigationConfig& config)
+	{
+		KeyHasher hasher;
+		hasher.add(NAVMESH_CACHE_VERSION);
+		hasher.add(board.getWidth());
+		hasher.add(board.getHeight());
+		for (int y = 0; y < board.getHeight(); y++)
+		{
+			for (int x = 0; x < board.getWidth(); x++)
+			{
+				hasher.add(board.get(x, y).isWalkable);
+			}
+		}
+
+		hasher.add(config.m_cellSize);
+		hasher.add(config.m_cellHeight);
+		hasher.add(config.m_agentHeight);
+		hasher.add(config.m_agentRadius);
+		hasher.add(config.m_agentMaxClimb);
+		hasher.add(config.m_agentMaxSlope);
+		hasher.add(config.m_regionMinSize);
+		hasher.add(config.m_regionMergeSize);
+		hasher.add(config.m_edgeMaxLen);
+		hasher.add(config.m_edgeMaxError);
+		hasher.add(config.m_vertsPerPoly);
+		hasher.add(config.m_detailSampleDist);
+		hasher.add(config.m_detailSampleMaxError);
+		hasher.add(config.m_partitionType);
+		hasher.add(config.m_tileSize);
+		hasher.add(config.m_gridClusterSize);
+		hasher.add(config.m_filterLowHangingObstacles);
+		hasher.add(config.m_filterLedgeSpans);
+		hasher.add(config.m_filterWalkableLowHeightSpans);
+		hasher.add(config.m_erodeWalkableArea);
+		return hasher.hash;
+	}
+
+	std::shared_ptr<Navigation> find(std::uint64_t key, const NavigationConfig& config, const std::filesystem::path& directory)
+	{
+		std::lock_guard<std::mutex> cacheGuard(cacheMutex);
+		if (auto navigation = findUnlocked(key))
+			return navigation;
+
+		if (directory.empty())
+			return nullptr;
+
+		std::vector<unsigned char> data;
+		if (!readFile(getFilePath(directory, key), data))
+			return nullptr;
+
+		auto navigation = deserialize(data, config);
+		if (navigation == nullptr)
+			return nullptr;
+
+		insertUnlocked(key, navigation);
+		return navigation;
+	}
+
+	std::shared_ptr<Navigation> store(std::uint64_t key, std::shared_ptr<Navigation> navigation, const std::filesystem::path& directory)
+	{
+		{
+			std::lock_guard<std::mutex> cacheGuard(cacheMutex);
+			if (auto storedNavigation = findUnlocked(key))
+				return storedNavigation;
+
+			insertUnlocked(key, navigation);
+		}
+
+		// Nobody modifies the navmesh anymore, so it can be written without holding the lock
+		if (!directory.empty())
+			writeFile(getFilePath(directory, key), serialize(*navigation));
+
+		return navigation;
+	}
+
+	std::shared_ptr<Navigation> copy(const Navigation& navigation)
+	{
+		return deserialize(serialize(navigation), navigation.config);
+	}
+
+	std::vector<unsigned char> serialize(const Navigation& navigation)
+	{
+		std::vector<unsigned char> data;
+		if (navigation.m_tileCache == nullptr)
+			return data;
+
+		const auto& tileCache = *navigation.m_tileCache;
+		NavigationCacheHeader header;
+		memset(&header, 0, sizeof(header));
+		header.magic = NAVMESH_CACHE_MAGIC;
+		header.version = NAVMESH_CACHE_VERSION;
+		header.tileCountX = navigation.m_tileCountX;
+		header.tileCountY = navigation.m_tileCountY;
+		memcpy(&header.cfg, &navigation.m_cfg, sizeof(header.cfg));
+		memcpy(&header.tileCacheParams, tileCache.getParams(), sizeof(header.tileCacheParams));
+		memcpy(&header.navMeshParams, navigation.m_navMesh->getParams(), sizeof(header.navMeshParams));
+
+		size_t size = sizeof(header);
+		for (int i = 0; i < tileCache.getTileCount(); i++)
+		{
+			const auto* tile = tileCache.getTile(i);
+			if (tile->header == nullptr || tile->dataSize == 0)
+				continue;
+
+			header.tileCount++;
+			size += sizeof(int) + tile->dataSize;
+		}
+
+		data.resize(size);
+		auto* out = data.data();
+		memcpy(out, &header, sizeof(header));
+		out += sizeof(header);
+		for (int i = 0; i < tileCache.getTileCount(); i++)
+		{
+			const auto* tile = tileCache.getTile(i);
+			if (tile->header == nullptr || tile->dataSize == 0)
+				continue;
+
+			memcpy(out, &tile->dataSize, sizeof(int));
+			out += sizeof(int);
+			memcpy(out, tile->data, tile->dataSize);
+			out += tile->dataSize;
+		}
+
+		return data;
+	}
+
+	std::shared_ptr<Navigation> deserialize(const std::vector<unsigned char>& data, const NavigationConfig& config)
+	{
+		NavigationCacheHeader header;
+		if (data.size() < sizeof(header))
+			return nullptr;
+
+		memcpy(&header, data.data(), sizeof(header));
+		if (header.magic != NAVMESH_CACHE_MAGIC || header.version != NAVMESH_CACHE_VERSION)
+			return nullptr;
+
+		auto navigation = std::make_shared<Navigation>();
+		navigation->config = config;
+		memcpy(&navigation->m_cfg, &header.cfg, sizeof(header.cfg));
+		navigation->m_tileCountX = header.tileCountX;
+		navigation->m_tileCountY = header.tileCountY;
+		if (!navigation->init(header.tileCacheParams, header.navMeshParams))
+			return nullptr;
+
+		size_t offset = sizeof(header);
+		for (int i = 0; i < header.tileCount; i++)
+		{
+			int dataSize = 0;
+			if (offset + sizeof(int) > data.size())
+				return nullptr;
+			memcpy(&dataSize, data.data() + offset, sizeof(int));
+			offset += sizeof(int);
+			if (dataSize <= 0 || offset + dataSize > data.size())
+				return nullptr;
+
+			auto* tileData = static_cast<unsigned char*>(dtAlloc(dataSize, DT_ALLOC_PERM));
+			if (tileData == nullptr)
+				return nullptr;
+			memcpy(tileData, data.data() + offset, dataSize);
+			offset += dataSize;
+
+			if (dtStatusFailed(navigation->m_tileCache->addTile(tileData, dataSize, DT_COMPRESSEDTILE_FREE_DATA, 0)))
+				dtFree(tileData);
+		}
+
+		for (int ty = 0; ty < navigation->m_tileCountY; ty++)
+		{
+			for (int tx = 0; tx < navigation->m_tileCountX; tx++)
+			{
+				navigation->m_tileCache->buildNavMeshTilesAt(tx, ty, navigation->m_navMesh);
+			}
+		}
+
+		navigation->updateCellPolys();
+		return navigation;
+	}
+
+	void clear()
+	{
+		std::lock_guard<std::mutex> cacheGuard(cacheMutex);
+		navigations.clear();
+		lastNavigation.reset();
+	}
+}
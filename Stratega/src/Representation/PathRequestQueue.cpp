@@ -0,0 +1,148 @@
+#include <Stratega/Representation/PathRequestQueue.h>
+#include "DetourNavMeshQuery.h"
+
+namespace SGA
+{
+	PathRequestQueue::PathRequestQueue(int maxIterationsPerTick)
+		: maxIterationsPerTick(maxIterationsPerTick),
+		  nextHandle(0)
+	{
+	}
+
+	int PathRequestQueue::request(const std::shared_ptr<Navigation>& navigation, const Vector2f& startPos, const Vector2f& endPos)
+	{
+		if (navigation == nullptr)
+			return -1;
+
+		std::shared_lock<NavMeshLock> navMeshGuard(navigation->m_navMeshLock);
+		auto query = navigation->m_queryPool.acquire();
+		if (query == nullptr)
+			return -1;
+
+		//Convert grid pos to 3D pos
+		Request request{};
+		request.startPos[0] = startPos.x;
+		request.startPos[2] = startPos.y;
+		request.endPos[0] = endPos.x;
+		request.endPos[2] = endPos.y;
+
+		//Find start and end poly, this is cheap compared to the search itself
+		request.startRef = navigation->findPoly(*query, request.startPos);
+		request.endRef = navigation->findPoly(*query, request.endPos);
+		if (!request.startRef || !request.endRef)
+			return -1;
+
+		request.handle = nextHandle++;
+		request.ref = DT_PATHQ_INVALID;
+		waitingRequests.emplace_back(request);
+		return request.handle;
+	}
+
+	void PathRequestQueue::cancel(int handle)
+	{
+		// dtPathQueue has no cancel, submitted requests are dropped once their result expires
+		submittedRequests.erase(handle);
+		for (auto it = waitingRequests.begin(); it != waitingRequests.end(); ++it)
+		{
+			if (it->handle == handle)
+			{
+				waitingRequests.erase(it);
+				return;
+			}
+		}
+	}
+
+	dtStatus PathRequestQueue::getRequestStatus(int handle) const
+	{
+		auto it = submittedRequests.find(handle);
+		if (it != submittedRequests.end())
+		{
+			auto status = pathQueue.getRequestStatus(it->second.ref);
+			// A status of 0 means the request was not started yet
+			return status == 0 ? DT_IN_PROGRESS : status;
+		}
+
+		for (const auto& request : waitingRequests)
+		{
+			if (request.handle == handle)
+				return DT_IN_PROGRESS;
+		}
+
+		return DT_FAILURE | DT_INVALID_PARAM;
+	}
+
+	bool PathRequestQueue::getPathResult(int handle, const Vector2f& startPos, Path& path)
+	{
+		auto it = submittedRequests.find(handle);
+		if (it == submittedRequests.end())
+			return false;
+
+		auto request = it->second;
+		submittedRequests.erase(it);
+
+		//Polys found in search
+		dtPolyRef polys[MAX_POLYS];
+		int npolys = 0;
+		if (dtStatusFailed(pathQueue.getPathResult(request.ref, polys, &npolys, MAX_POLYS)) || npolys == 0)
+			return false;
+
+		// The unit kept moving while the request was pending, Detour clamps the start position to the first polygon
+		float startPosV3[3] = { startPos.x, 0, startPos.y };
+
+		std::shared_lock<NavMeshLock> navMeshGuard(navigation->m_navMeshLock);
+		auto query = navigation->m_queryPool.acquire();
+		if (query == nullptr)
+			return false;
+
+		// In case of partial path, make sure the end point is clamped to the last polygon.
+		if (polys[npolys - 1] != request.endRef)
+			query->closestPointOnPoly(polys[npolys - 1], request.endPos, request.endPos, 0);
+
+		path.m_nstraightPath = 0;
+		query->findStraightPath(startPosV3, request.endPos, polys, npolys,
+			path.m_straightPath, path.m_straightPathFlags,
+			path.m_straightPathPolys, &path.m_nstraightPath, MAX_POLYS, path.m_straightPathOptions);
+
+		return path.m_nstraightPath > 0;
+	}
+
+	void PathRequestQueue::update(const std::shared_ptr<Navigation>& navigation)
+	{
+		if (navigation == nullptr || navigation->m_navMesh == nullptr)
+			return;
+
+		// The navmesh was rebuilt, pending requests refer to polygons that do not exist anymore
+		if (navigation != this->navigation)
+		{
+			this->navigation = navigation;
+			pathQueue.init(MAX_POLYS, 2048, navigation->m_navMesh);
+			waitingRequests.clear();
+			submittedRequests.clear();
+		}
+
+		// Forget requests whose results were never collected, dtPathQueue already dropped them
+		for (auto it = submittedRequests.begin(); it != submittedRequests.end();)
+		{
+			if (pathQueue.getRequestStatus(it->second.ref) == DT_FAILURE)
+				it = submittedRequests.erase(it);
+			else
+				++it;
+		}
+
+		std::shared_lock<NavMeshLock> navMeshGuard(navigation->m_navMeshLock);
+
+		// Fill the free slots of the dtPathQueue
+		while (!waitingRequests.empty())
+		{
+			auto& request = waitingRequests.front();
+			request.ref = pathQueue.request(request.startRef, request.endRef, request.startPos, request.endPos, &navigation->m_filter);
+			if (request.ref == DT_PATHQ_INVALID)
+				break;
+
+			submittedRequests.emplace(request.handle, request);
+			waitingRequests.pop_front();
+		}
+
+		pathQueue.update(maxIterationsPerTick);
+	}
+}
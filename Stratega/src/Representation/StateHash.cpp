@@ -0,0 +1,111 @@
+#include <Stratega/Representation/StateHash.h>
+
+#include <bit>
+
+namespace SGA
+{
+	namespace
+	{
+		// Finalizer of splitmix64
+		std::uint64_t mix(std::uint64_t value)
+		{
+			value += 0x9e3779b97f4a7c15ull;
+			value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+			value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+			return value ^ (value >> 31);
+		}
+
+		class StateHasher
+		{
+		public:
+			void add(std::uint64_t value) { hash = mix(hash ^ value); }
+			void add(int value) { add(static_cast<std::uint64_t>(static_cast<std::uint32_t>(value))); }
+			void add(bool value) { add(static_cast<std::uint64_t>(value)); }
+			void add(float value) { add(static_cast<std::uint64_t>(std::bit_cast<std::uint32_t>(value))); }
+			void add(double value) { add(std::bit_cast<std::uint64_t>(value)); }
+
+			void add(const std::vector<double>& values)
+			{
+				add(static_cast<std::uint64_t>(values.size()));
+				for (double value : values)
+					add(value);
+			}
+
+			void add(const std::vector<ActionInfo>& actions)
+			{
+				add(static_cast<std::uint64_t>(actions.size()));
+				for (const auto& action : actions)
+				{
+					add(action.actionTypeID);
+					add(action.lastExecutedTick);
+				}
+			}
+
+			void add(const std::vector<Action>& continuousActions)
+			{
+				add(static_cast<std::uint64_t>(continuousActions.size()));
+				for (const auto& action : continuousActions)
+				{
+					add(action.actionTypeID);
+					add(action.elapsedTicks);
+				}
+			}
+
+			std::uint64_t hash = 0;
+		};
+	}
+
+	std::uint64_t hashState(const GameState& state)
+	{
+		StateHasher hasher;
+		hasher.add(state.isGameOver);
+		hasher.add(state.winnerPlayerID);
+		hasher.add(state.currentTick);
+
+		for (const auto& player : state.players)
+		{
+			hasher.add(player.id);
+			hasher.add(player.score);
+			hasher.add(player.canPlay);
+			hasher.add(player.parameters);
+			hasher.add(player.attachedActions);
+			hasher.add(player.continuousAction);
+		}
+
+		// the sum does not depend on the order of the entities
+		std::uint64_t entitiesHash = 0;
+		for (const auto& entity : state.entities)
+		{
+			StateHasher entityHasher;
+			entityHasher.add(entity.id);
+			entityHasher.add(entity.typeID);
+			entityHasher.add(entity.ownerID);
+			entityHasher.add(entity.position.x);
+			entityHasher.add(entity.position.y);
+			entityHasher.add(entity.parameters);
+			entityHasher.add(entity.attachedActions);
+			entityHasher.add(entity.continuousAction);
+			entitiesHash += entityHasher.hash;
+		}
+		hasher.add(entitiesHash);
+
+		return hasher.hash;
+	}
+
+	std::uint64_t hashState(const TBSGameState& state)
+	{
+		return mix(hashState(static_cast<const GameState&>(state)) ^ static_cast<std::uint32_t>(state.currentPlayer));
+	}
+
+	std::uint64_t hashAction(const Action& action)
+	{
+		StateHasher hasher;
+		hasher.add(static_cast<int>(action.actionTypeFlags));
+		hasher.add(action.actionTypeID);
+		hasher.add(action.ownerID);
+		hasher.add(action.continuousActionID);
+		for (const auto& target : action.targets)
+			hasher.add(target.getHash());
+		return hasher.hash;
+	}
+}
@@ -6,6 +6,13 @@
 
 typedef std::unique_ptr<SGA::TBSGameState> (*StateGenerator)(std::mt19937& rngEngine);
 
+struct NavMeshRebuildResult
+{
+	int paths = 0;
+	// Paths of the incrementally updated navmesh that differ from the paths of a navmesh built from scratch
+	int differingPaths = 0;
+};
+
 class FMEvaluator
 {
 public:
@@ -14,6 +21,14 @@ public:
 	size_t StepCount = 100000;
 	std::unique_ptr<FMEvaluationResults> evaluate(const SGA::GameConfig& config);
 
+	size_t BlockedTileCount = 8;
+	size_t PathCount = 200;
+	/// <summary>
+	/// Makes tiles of an RTS board unwalkable and rebuilds only the affected part of the navmesh, with an obstacle added and removed again.
+	/// Afterwards paths between random tiles are compared with the paths of a navmesh that is built from scratch for the changed board.
+	/// </summary>
+	NavMeshRebuildResult evaluateNavMeshRebuild(const SGA::GameConfig& config);
+
 private:
 	void runGameTBS(SGA::TBSGameState& state, SGA::TBSForwardModel& fm, FMEvaluationResults& results);
 	void runGameRTS(SGA::RTSGameState& state, SGA::RTSForwardModel& fm, FMEvaluationResults& results);
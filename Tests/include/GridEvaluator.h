@@ -0,0 +1,45 @@
+#pragma once
+#include <random>
+#include <string>
+#include <vector>
+#include <Stratega/Configuration/GameConfig.h>
+#include <Stratega/ForwardModel/RTSForwardModel.h>
+
+struct GridEvaluationResult
+{
+	std::string board;
+	std::string backend;
+	double buildMs;
+	double usPerPath;
+	int foundPaths;
+	// Pairs where finding a path disagrees with the exact reachability of a flow field
+	int reachabilityMismatches;
+	// Paths with a segment that crosses an un-walkable tile, Detour simplifies the navmesh contours and can cut corners
+	int blockedPaths;
+};
+
+/// <summary>
+/// Compares the grid pathfinding with the Detour navmesh on the board of an RTS game and on generated large boards.
+/// Measures the build time and the cost of findPath for random pairs of walkable tiles,
+/// and checks the paths against the reachability of flow fields, which are exact on the tiles.
+/// </summary>
+class GridEvaluator
+{
+public:
+	GridEvaluator(std::mt19937& rngEngine);
+
+	size_t PathCount = 1000;
+	// Only the first pairs are checked against flow fields, a flow field covers the whole board
+	size_t CheckedPathCount = 200;
+	int GeneratedBoardSize = 256;
+	std::vector<int> GeneratedObstaclePercentages = { 0, 10, 25 };
+
+	std::vector<GridEvaluationResult> evaluate(const SGA::GameConfig& config);
+
+private:
+	// A board crossed by walls with gaps, random tiles are blocked additionally
+	SGA::Grid2D<SGA::Tile> generateBoard(int obstaclePercentage);
+	void evaluateBoard(const std::string& name, const SGA::RTSForwardModel& forwardModel, const SGA::RTSGameState& state, std::vector<GridEvaluationResult>& results);
+
+	std::mt19937* rngEngine;
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <random>
+#include <string>
+#include <vector>
+#include <Stratega/Configuration/GameConfig.h>
+
+struct HeuristicEvaluationResult
+{
+	std::string name;
+	double nsPerEvaluation;
+	// Share of the states whose value equals the value of the reference implementation
+	double agreement;
+};
+
+/// <summary>
+/// Measures the cost of a single evaluation of the MinimizeDistanceHeuristic.
+/// The previous implementation with a map of the positions and sets of the entities is kept as a reference, so that both are measured on the same states.
+/// </summary>
+class HeuristicEvaluator
+{
+public:
+	HeuristicEvaluator(std::mt19937& rngEngine);
+
+	size_t StateCount = 100;
+	int Repetitions = 10000;
+
+	std::vector<HeuristicEvaluationResult> evaluate(const SGA::GameConfig& config);
+
+private:
+	std::vector<SGA::TBSGameState> sampleStates(const SGA::GameConfig& config, SGA::TBSForwardModel& fm);
+
+	std::mt19937* rngEngine;
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <Stratega/Configuration/GameConfig.h>
+
+struct MCTSEvaluationResult
+{
+	std::string mode;
+	int threads;
+	// Forward model calls the search could afford within the time budget
+	double fmCalls;
+	double durationMs;
+	// Share of the decisions that equal the decision of the reference search
+	double agreement;
+};
+
+/// <summary>
+/// Compares the parallel modes of the MCTS agent at equal wall-clock budgets.
+/// For every sampled state the forward model calls each mode can do within the budget are measured first,
+/// then the mode searches with that many calls and its decision is compared with a long single-threaded search.
+/// </summary>
+class MCTSEvaluator
+{
+public:
+	MCTSEvaluator(std::mt19937& rngEngine);
+
+	size_t StateCount = 10;
+	std::chrono::milliseconds Budget = std::chrono::milliseconds(200);
+	int CalibrationFMCalls = 200;
+	int ReferenceFMCalls = 20000;
+
+	std::vector<MCTSEvaluationResult> evaluate(const SGA::GameConfig& config);
+
+private:
+	std::vector<SGA::TBSGameState> sampleStates(const SGA::GameConfig& config, SGA::TBSForwardModel& fm);
+
+	std::mt19937* rngEngine;
+};
@@ -2,6 +2,9 @@
 #include <filesystem>
 #include <yaml-cpp/yaml.h>
 #include <FMEvaluator.h>
+#include <MCTSEvaluator.h>
+#include <HeuristicEvaluator.h>
+#include <GridEvaluator.h>
 
 #include <Stratega/Configuration/GameConfig.h>
 #include <Stratega/Configuration/GameConfigParser.h>
@@ -23,6 +26,50 @@ int main(int argc, char **argv)
 
 	std::cout << "Passed game is a " << (gameConfig.gameType == SGA::ForwardModelType::TBS ? "TBS" : "RTS") << " game" << std::endl;
 	
+	// Pass mcts as second argument to compare the parallel modes of the MCTS agent instead
+	if (argc > 2 && std::string(argv[2]) == "mcts")
+	{
+		MCTSEvaluator evaluator(rngEngine);
+		for (const auto& result : evaluator.evaluate(gameConfig))
+		{
+			std::cout << result.mode << " threads: " << result.threads << " FM calls: " << result.fmCalls
+				<< " ms: " << result.durationMs << " agreement: " << result.agreement << std::endl;
+		}
+		return 0;
+	}
+
+	// Pass heuristic as second argument to measure the cost of an evaluation of the MinimizeDistanceHeuristic instead
+	if (argc > 2 && std::string(argv[2]) == "heuristic")
+	{
+		HeuristicEvaluator evaluator(rngEngine);
+		for (const auto& result : evaluator.evaluate(gameConfig))
+		{
+			std::cout << result.name << " ns per evaluation: " << result.nsPerEvaluation << " agreement: " << result.agreement << std::endl;
+		}
+		return 0;
+	}
+
+	// Pass grid as second argument to compare the grid pathfinding of an RTS game with the Detour navmesh instead
+	if (argc > 2 && std::string(argv[2]) == "grid")
+	{
+		GridEvaluator evaluator(rngEngine);
+		for (const auto& result : evaluator.evaluate(gameConfig))
+		{
+			std::cout << result.board << " " << result.backend << " build ms: " << result.buildMs << " us per path: " << result.usPerPath
+				<< " found: " << result.foundPaths << " reachability mismatches: " << result.reachabilityMismatches << " blocked paths: " << result.blockedPaths << std::endl;
+		}
+		return 0;
+	}
+
+	// Pass navmesh as second argument to compare the incremental navmesh rebuild of an RTS game with a rebuild from scratch instead
+	if (argc > 2 && std::string(argv[2]) == "navmesh")
+	{
+		FMEvaluator evaluator(rngEngine);
+		auto result = evaluator.evaluateNavMeshRebuild(gameConfig);
+		std::cout << "paths: " << result.paths << " differing paths: " << result.differingPaths << std::endl;
+		return result.differingPaths == 0 ? 0 : 1;
+	}
+
 	FMEvaluator evaluator(rngEngine);
 	auto results = evaluator.evaluate(gameConfig);
 	std::cout << "FPS: " << results->computeFPS() << std::endl;
@@ -74,4 +74,77 @@ void FMEvaluator::runGameRTS(SGA::RTSGameState& state, SGA::RTSForwardModel& fm,
 		results.getActionsDurations.emplace_back(std::chrono::duration_cast<std::chrono::microseconds>(getActionsEnd - getActionsStart));
 		results.executeActionDurations.emplace_back(std::chrono::duration_cast<std::chrono::microseconds>(executeActionEnd - executeActionStart));
 	}
-}
\ No newline at end of file
+}
+
+NavMeshRebuildResult FMEvaluator::evaluateNavMeshRebuild(const SGA::GameConfig& config)
+{
+	NavMeshRebuildResult result;
+	auto* fm = dynamic_cast<SGA::RTSForwardModel*>(config.forwardModel.get());
+	if (fm == nullptr)
+		return result;
+
+	auto statePtr = config.generateGameState();
+	auto& state = *dynamic_cast<SGA::RTSGameState*>(statePtr.get());
+	fm->buildNavMesh(state, SGA::NavigationConfig());
+
+	std::vector<SGA::Vector2i> walkableTiles;
+	for (int y = 0; y < state.board.getHeight(); y++)
+	{
+		for (int x = 0; x < state.board.getWidth(); x++)
+		{
+			if (state.board.get(x, y).isWalkable)
+				walkableTiles.emplace_back(x, y);
+		}
+	}
+
+	// Block random tiles, only the navmesh tiles around them are rebuilt
+	std::shuffle(walkableTiles.begin(), walkableTiles.end(), *rngEngine);
+	const size_t blockedTileCount = std::min(BlockedTileCount, walkableTiles.size() / 2);
+	for (size_t i = 0; i < blockedTileCount; i++)
+	{
+		state.board.get(walkableTiles[i].x, walkableTiles[i].y).isWalkable = false;
+		fm->invalidateNavMesh(state, walkableTiles[i]);
+	}
+	walkableTiles.erase(walkableTiles.begin(), walkableTiles.begin() + blockedTileCount);
+	while (!fm->updateNavMesh(state, 1000))
+		;
+
+	// An obstacle that is removed again has to leave the navmesh as it was
+	if (!walkableTiles.empty())
+	{
+		const auto& obstacleTile = walkableTiles.front();
+		auto obstacle = fm->addNavMeshObstacle(state, SGA::Vector2f(obstacleTile.x + 0.5f, obstacleTile.y + 0.5f), 1.5f);
+		while (!fm->updateNavMesh(state, 1000))
+			;
+		fm->removeNavMeshObstacle(state, obstacle);
+		while (!fm->updateNavMesh(state, 1000))
+			;
+	}
+
+	auto rebuiltState = state;
+	fm->buildNavMesh(rebuiltState, SGA::NavigationConfig());
+
+	if (walkableTiles.empty())
+		return result;
+
+	std::uniform_int_distribution<size_t> tileDist(0, walkableTiles.size() - 1);
+	for (size_t i = 0; i < PathCount; i++)
+	{
+		const auto& start = walkableTiles[tileDist(*rngEngine)];
+		const auto& end = walkableTiles[tileDist(*rngEngine)];
+		SGA::Vector2f startPos(start.x + 0.5f, start.y + 0.5f);
+		SGA::Vector2f endPos(end.x + 0.5f, end.y + 0.5f);
+		auto path = fm->findPath(state, startPos, endPos);
+		auto rebuiltPath = fm->findPath(rebuiltState, startPos, endPos);
+
+		bool equal = path.m_nstraightPath == rebuiltPath.m_nstraightPath;
+		for (int j = 0; equal && j < path.m_nstraightPath * 3; j++)
+			equal = std::abs(path.m_straightPath[j] - rebuiltPath.m_straightPath[j]) < 1e-4f;
+
+		result.paths++;
+		if (!equal)
+			result.differingPaths++;
+	}
+
+	return result;
+}
@@ -0,0 +1,140 @@
+#include <GridEvaluator.h>
+#include <Stratega/Representation/FlowField.h>
+#include <Stratega/Representation/NavigationCache.h>
+
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+	// Samples the segments of the path, the tiles below the samples have to be walkable.
+	// Samples on the edge of a tile are skipped, navmesh paths follow the edges of un-walkable tiles
+	bool crossesBlockedTile(const SGA::Grid2D<SGA::Tile>& board, const SGA::Path& path)
+	{
+		const float edgeTolerance = 1e-3f;
+		for (int i = 1; i < path.m_nstraightPath; i++)
+		{
+			const float startX = path.m_straightPath[(i - 1) * 3];
+			const float startY = path.m_straightPath[(i - 1) * 3 + 2];
+			const float deltaX = path.m_straightPath[i * 3] - startX;
+			const float deltaY = path.m_straightPath[i * 3 + 2] - startY;
+			const int samples = static_cast<int>(std::ceil(std::sqrt(deltaX * deltaX + deltaY * deltaY) * 20)) + 1;
+			for (int sample = 0; sample <= samples; sample++)
+			{
+				const float sampleX = startX + deltaX * sample / samples;
+				const float sampleY = startY + deltaY * sample / samples;
+				const int x = static_cast<int>(std::floor(sampleX));
+				const int y = static_cast<int>(std::floor(sampleY));
+				const bool isOnEdge = std::min(sampleX - x, x + 1 - sampleX) < edgeTolerance || std::min(sampleY - y, y + 1 - sampleY) < edgeTolerance;
+				if (!isOnEdge && (!board.isInBounds(x, y) || !board.get(x, y).isWalkable))
+					return true;
+			}
+		}
+		return false;
+	}
+}
+
+GridEvaluator::GridEvaluator(std::mt19937& rngEngine)
+	: rngEngine(&rngEngine)
+{
+}
+
+SGA::Grid2D<SGA::Tile> GridEvaluator::generateBoard(int obstaclePercentage)
+{
+	std::uniform_int_distribution<int> percentageDist(0, 99);
+	std::vector<SGA::Tile> tiles;
+	for (int y = 0; y < GeneratedBoardSize; y++)
+	{
+		for (int x = 0; x < GeneratedBoardSize; x++)
+		{
+			SGA::Tile tile(0, x, y);
+			const bool isWall = (x % 40 == 20 && y % 40 > 4) || (y % 40 == 30 && x % 40 < 34);
+			tile.isWalkable = !isWall && percentageDist(*rngEngine) >= obstaclePercentage;
+			tiles.emplace_back(tile);
+		}
+	}
+	return SGA::Grid2D<SGA::Tile>(GeneratedBoardSize, tiles.begin(), tiles.end());
+}
+
+std::vector<GridEvaluationResult> GridEvaluator::evaluate(const SGA::GameConfig& config)
+{
+	if (config.gameType != SGA::ForwardModelType::RTS)
+		throw std::runtime_error("The grid evaluation supports only RTS games");
+
+	// Every build is measured, so the navmeshes are neither loaded from nor written to the disk
+	auto fm = *dynamic_cast<SGA::RTSForwardModel*>(config.forwardModel.get());
+	fm.navMeshCacheDirectory.clear();
+	auto statePtr = config.generateGameState();
+	auto state = *dynamic_cast<SGA::RTSGameState*>(statePtr.get());
+
+	std::vector<GridEvaluationResult> results;
+	evaluateBoard("game board", fm, state, results);
+	for (int obstaclePercentage : GeneratedObstaclePercentages)
+	{
+		state.board = generateBoard(obstaclePercentage);
+		evaluateBoard(std::to_string(GeneratedBoardSize) + " walls + " + std::to_string(obstaclePercentage) + "%", fm, state, results);
+	}
+
+	return results;
+}
+
+void GridEvaluator::evaluateBoard(const std::string& name, const SGA::RTSForwardModel& forwardModel, const SGA::RTSGameState& state, std::vector<GridEvaluationResult>& results)
+{
+	const auto& board = state.board;
+	std::vector<SGA::Vector2i> walkableTiles;
+	for (int y = 0; y < board.getHeight(); y++)
+	{
+		for (int x = 0; x < board.getWidth(); x++)
+		{
+			if (board.get(x, y).isWalkable)
+				walkableTiles.emplace_back(x, y);
+		}
+	}
+	if (walkableTiles.empty())
+		return;
+
+	// Both backends search the same pairs
+	std::uniform_int_distribution<size_t> tileDist(0, walkableTiles.size() - 1);
+	std::vector<std::pair<SGA::Vector2i, SGA::Vector2i>> pairs;
+	for (size_t i = 0; i < PathCount; i++)
+		pairs.emplace_back(walkableTiles[tileDist(*rngEngine)], walkableTiles[tileDist(*rngEngine)]);
+
+	std::vector<bool> isReachable;
+	for (size_t i = 0; i < std::min(CheckedPathCount, pairs.size()); i++)
+		isReachable.emplace_back(SGA::FlowField(board, pairs[i].second).isReachable(pairs[i].first));
+
+	for (auto pathfinding : { SGA::PathfindingType::Navmesh, SGA::PathfindingType::Grid })
+	{
+		auto fm = forwardModel;
+		fm.pathfinding = pathfinding;
+		auto backendState = state;
+		SGA::NavigationCache::clear();
+
+		GridEvaluationResult result{ name, pathfinding == SGA::PathfindingType::Grid ? "Grid" : "Detour", 0, 0, 0, 0, 0 };
+		const auto buildStart = std::chrono::steady_clock::now();
+		fm.buildNavMesh(backendState, SGA::NavigationConfig());
+		result.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+
+		const auto searchStart = std::chrono::steady_clock::now();
+		for (const auto& [start, end] : pairs)
+		{
+			auto path = fm.findPath(backendState, SGA::Vector2f(start.x + 0.5f, start.y + 0.5f), SGA::Vector2f(end.x + 0.5f, end.y + 0.5f));
+			if (path.m_nstraightPath > 0)
+				result.foundPaths++;
+		}
+		result.usPerPath = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - searchStart).count() / pairs.size();
+
+		// the paths are searched again for the checks, so that they do not count into the time
+		for (size_t i = 0; i < isReachable.size(); i++)
+		{
+			const auto& [start, end] = pairs[i];
+			auto path = fm.findPath(backendState, SGA::Vector2f(start.x + 0.5f, start.y + 0.5f), SGA::Vector2f(end.x + 0.5f, end.y + 0.5f));
+			const bool found = path.m_nstraightPath > 0;
+			if (found != isReachable[i])
+				result.reachabilityMismatches++;
+			if (found && crossesBlockedTile(board, path))
+				result.blockedPaths++;
+		}
+		results.emplace_back(result);
+	}
+}
@@ -0,0 +1,131 @@
+#include <HeuristicEvaluator.h>
+#include <Stratega/Agent/Heuristic/MinimizeDistanceHeuristic.h>
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <set>
+
+namespace
+{
+	// The implementation of the MinimizeDistanceHeuristic before it was rewritten over flat position arrays
+	double referenceEvaluate(SGA::TBSGameState& gameState, int playerID)
+	{
+		double score = 0.0;
+
+		if (gameState.isGameOver)
+		{
+			if (gameState.winnerPlayerID == playerID)
+				score -= 1000;
+			else
+				score += 1000;
+		}
+
+		std::map<int, SGA::Vector2f> positions;
+		std::set<int> opponentEntites = std::set<int>();
+		std::set<int> playerEntities = std::set<int>();
+
+		for (const auto& entity : gameState.entities)
+		{
+			positions.emplace(entity.id, entity.position);
+			if (entity.ownerID != gameState.currentPlayer)
+			{
+				opponentEntites.insert(entity.id);
+			}
+			else
+			{
+				playerEntities.insert(entity.id);
+			}
+		}
+
+		double sumOfAverageDistances = 0;
+		for (const auto& playerUnit : playerEntities)
+		{
+			double sumOfDistances = 0;
+			auto a = positions[playerUnit];
+			for (int opponentUnit : opponentEntites)
+			{
+				auto b = positions[opponentUnit];
+				sumOfDistances += std::abs(a.x - b.x) + std::abs(a.y - b.y);
+			}
+			sumOfAverageDistances = sumOfDistances / opponentEntites.size();
+		}
+		score += sumOfAverageDistances / playerEntities.size();
+
+		return score;
+	}
+
+	bool isSameValue(double a, double b)
+	{
+		return a == b || (std::isnan(a) && std::isnan(b));
+	}
+}
+
+HeuristicEvaluator::HeuristicEvaluator(std::mt19937& rngEngine)
+	: rngEngine(&rngEngine)
+{
+}
+
+std::vector<SGA::TBSGameState> HeuristicEvaluator::sampleStates(const SGA::GameConfig& config, SGA::TBSForwardModel& fm)
+{
+	// Play a few random actions, so that the units are spread over the board
+	std::vector<SGA::TBSGameState> states;
+	std::uniform_int_distribution<int> stepDist(0, 50);
+	while (states.size() < StateCount)
+	{
+		auto state = config.generateGameState();
+		auto& tbsState = *dynamic_cast<SGA::TBSGameState*>(state.get());
+		const int steps = stepDist(*rngEngine);
+		for (int i = 0; i < steps && !tbsState.isGameOver; i++)
+		{
+			auto actionSpace = fm.generateActions(tbsState);
+			std::uniform_int_distribution<int> actionDist(0, actionSpace.size() - 1);
+			fm.advanceGameState(tbsState, actionSpace.at(actionDist(*rngEngine)));
+		}
+		states.emplace_back(tbsState);
+	}
+	return states;
+}
+
+std::vector<HeuristicEvaluationResult> HeuristicEvaluator::evaluate(const SGA::GameConfig& config)
+{
+	if (config.gameType != SGA::ForwardModelType::TBS)
+		throw std::runtime_error("The heuristic evaluation supports only TBS games");
+
+	auto fm = *dynamic_cast<SGA::TBSForwardModel*>(config.forwardModel.get());
+	auto states = sampleStates(config, fm);
+
+	SGA::MinimizeDistanceHeuristic heuristic;
+	const std::vector<std::pair<std::string, std::function<double(SGA::TBSGameState&)>>> implementations = {
+		{ "Reference", [](SGA::TBSGameState& state) { return referenceEvaluate(state, 0); } },
+		{ "MinimizeDistanceHeuristic", [&](SGA::TBSGameState& state) { return heuristic.evaluateGameState(fm, state, 0); } }
+	};
+
+	std::vector<HeuristicEvaluationResult> results;
+	for (const auto& [name, implementation] : implementations)
+	{
+		HeuristicEvaluationResult result{ name, 0, 0 };
+		for (auto& state : states)
+		{
+			if (isSameValue(implementation(state), referenceEvaluate(state, 0)))
+				result.agreement += 1.0 / states.size();
+		}
+
+		// the values are summed up, so that the evaluations cannot be optimized away
+		double sum = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < Repetitions; i++)
+		{
+			for (auto& state : states)
+				sum += implementation(state);
+		}
+		const auto duration = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+		result.nsPerEvaluation = duration.count() / (static_cast<double>(Repetitions) * states.size());
+		volatile double sink = sum;
+		(void)sink;
+		results.emplace_back(result);
+	}
+
+	return results;
+}
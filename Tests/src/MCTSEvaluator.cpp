@@ -0,0 +1,113 @@
+#include <MCTSEvaluator.h>
+#include <Stratega/Agent/TreeSearchAgents/MCTSAgent.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace
+{
+	SGA::MCTSParameters createParameters(int threads, bool sharedTree, int fmCalls)
+	{
+		SGA::MCTSParameters params;
+		params.THREADS = threads;
+		params.SHARED_TREE = sharedTree;
+		params.MAX_FM_CALLS = std::max(1, fmCalls);
+		return params;
+	}
+
+	bool isSameAction(const SGA::TBSGameState& state, const SGA::Action& a, const SGA::Action& b)
+	{
+		if (a.actionTypeID != b.actionTypeID || a.actionTypeFlags != b.actionTypeFlags || a.targets.size() != b.targets.size())
+			return false;
+
+		for (size_t i = 0; i < a.targets.size(); i++)
+		{
+			if (a.targets[i].getType() != b.targets[i].getType())
+				return false;
+			if (a.targets[i].getType() == SGA::ActionTarget::Position && a.targets[i].getPosition(state) != b.targets[i].getPosition(state))
+				return false;
+			if (a.targets[i].getType() == SGA::ActionTarget::EntityReference && a.targets[i].getEntityID() != b.targets[i].getEntityID())
+				return false;
+		}
+		return true;
+	}
+}
+
+MCTSEvaluator::MCTSEvaluator(std::mt19937& rngEngine)
+	: rngEngine(&rngEngine)
+{
+}
+
+std::vector<SGA::TBSGameState> MCTSEvaluator::sampleStates(const SGA::GameConfig& config, SGA::TBSForwardModel& fm)
+{
+	// Play a few random actions, so that the searches do not all start from the initial state
+	std::vector<SGA::TBSGameState> states;
+	std::uniform_int_distribution<int> stepDist(0, 20);
+	while (states.size() < StateCount)
+	{
+		auto state = config.generateGameState();
+		auto& tbsState = *dynamic_cast<SGA::TBSGameState*>(state.get());
+		const int steps = stepDist(*rngEngine);
+		for (int i = 0; i < steps && !tbsState.isGameOver; i++)
+		{
+			auto actionSpace = fm.generateActions(tbsState);
+			std::uniform_int_distribution<int> actionDist(0, actionSpace.size() - 1);
+			fm.advanceGameState(tbsState, actionSpace.at(actionDist(*rngEngine)));
+		}
+
+		if (!tbsState.isGameOver && fm.generateActions(tbsState).size() > 1)
+			states.emplace_back(tbsState);
+	}
+	return states;
+}
+
+std::vector<MCTSEvaluationResult> MCTSEvaluator::evaluate(const SGA::GameConfig& config)
+{
+	if (config.gameType != SGA::ForwardModelType::TBS)
+		throw std::runtime_error("The MCTS evaluation supports only TBS games");
+
+	auto fm = *dynamic_cast<SGA::TBSForwardModel*>(config.forwardModel.get());
+	const auto states = sampleStates(config, fm);
+
+	std::vector<SGA::Action> referenceActions;
+	for (const auto& state : states)
+	{
+		SGA::MCTSAgent reference(createParameters(1, false, ReferenceFMCalls));
+		referenceActions.emplace_back(reference.searchAction(fm, state, *rngEngine));
+	}
+
+	// Compare at least two threads, so that the parallel modes are evaluated on machines with one core too
+	const int maxThreads = std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+	std::vector<std::pair<int, bool>> modes = { { 1, false } };
+	for (int threads = 2; threads <= maxThreads; threads *= 2)
+	{
+		modes.emplace_back(threads, false);
+		modes.emplace_back(threads, true);
+	}
+
+	std::vector<MCTSEvaluationResult> results;
+	for (const auto& [threads, sharedTree] : modes)
+	{
+		MCTSEvaluationResult result{ threads == 1 ? "Single" : (sharedTree ? "Tree" : "Root"), threads, 0, 0, 0 };
+		for (size_t i = 0; i < states.size(); i++)
+		{
+			SGA::MCTSAgent calibration(createParameters(threads, sharedTree, CalibrationFMCalls));
+			auto start = std::chrono::steady_clock::now();
+			calibration.searchAction(fm, states[i], *rngEngine);
+			const auto calibrationDuration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+			const double fmCalls = CalibrationFMCalls * std::chrono::duration<double>(Budget).count() / calibrationDuration.count();
+			SGA::MCTSAgent agent(createParameters(threads, sharedTree, static_cast<int>(fmCalls)));
+			start = std::chrono::steady_clock::now();
+			const auto action = agent.searchAction(fm, states[i], *rngEngine);
+			const auto duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+			result.fmCalls += fmCalls / states.size();
+			result.durationMs += duration.count() / states.size();
+			result.agreement += isSameAction(states[i], action, referenceActions[i]) ? 1.0 / states.size() : 0;
+		}
+		results.emplace_back(result);
+	}
+
+	return results;
+}